@@ -24,5 +24,5 @@ void setup(void) {
 
 void loop() {
 	gGameState.update();
-	usleep(10 * 1000);  
+	gGameState.waitForEvents();
 }
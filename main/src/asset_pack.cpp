@@ -0,0 +1,195 @@
+#include <Arduino.h>
+#include <string.h>
+#include "asset_pack.h"
+
+#ifdef ESP_PLATFORM
+  #include <esp_partition.h>
+  #include <esp_idf_version.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+bool AssetPack::open() {
+    if (isOpen()) {
+        return true;
+    }
+
+#ifdef ESP_PLATFORM
+    const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+        (esp_partition_subtype_t)ASSET_PARTITION_SUBTYPE, ASSET_PARTITION_NAME);
+    if (partition == nullptr) {
+        Serial.println(F("No asset partition"));
+        return false;
+    }
+
+    // mapped through the flash cache like PROGMEM, so reading it costs the same
+    const void* base = nullptr;
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_partition_mmap_handle_t handle;
+    esp_err_t err = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &base, &handle);
+#else
+    spi_flash_mmap_handle_t handle;
+    esp_err_t err = esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA, &base, &handle);
+#endif
+    if (err != ESP_OK) {
+        Serial.println(F("Could not map the asset partition"));
+        return false;
+    }
+    return check((const uint8_t*)base, partition->size);
+#else
+    const char* path = getenv("ASSET_PACK");
+    if (path == nullptr) {
+        path = ASSET_PACK_PATH;
+    }
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        Serial.println(F("No asset pack file"));
+        return false;
+    }
+    struct stat info;
+    void* base = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        base = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED) {
+        Serial.println(F("Could not map the asset pack file"));
+        return false;
+    }
+    return check((const uint8_t*)base, (uint32_t)info.st_size);
+#endif
+}
+
+bool AssetPack::check(const uint8_t* base, uint32_t size) {
+    // a partition that was never flashed reads as 0xff
+    const AssetPackHeader* header = (const AssetPackHeader*)base;
+    if (size < sizeof(AssetPackHeader) || header->magic != ASSET_PACK_MAGIC) {
+        Serial.println(F("Asset pack missing"));
+        return false;
+    }
+    if (header->version != ASSET_PACK_VERSION || header->size > size
+        || sizeof(AssetPackHeader) + header->count * sizeof(AssetEntry) > header->size) {
+        Serial.println(F("Asset pack bad header"));
+        return false;
+    }
+
+    // every entry has to lie inside the pack, so nothing reads past it later
+    const AssetEntry* index = (const AssetEntry*)(base + sizeof(AssetPackHeader));
+    for (int i = 0; i < header->count; ++i) {
+        const AssetEntry& entry = index[i];
+        const uint64_t silence = (uint64_t)entry.silenceCount * sizeof(SoundRun);
+        if ((uint64_t)entry.offset + entry.size > header->size
+            || entry.silenceOffset + silence > header->size
+            || (entry.silenceOffset & 3) != 0) {
+            Serial.print(F("Asset pack bad entry "));
+            Serial.println(i);
+            return false;
+        }
+    }
+
+    mBase = base;
+    mIndex = index;
+    mCount = header->count;
+    return true;
+}
+
+const AssetEntry* AssetPack::find(AssetKind kind, const char* name) const {
+    for (int i = 0; i < mCount; ++i) {
+        if (mIndex[i].kind == kind && strncmp(mIndex[i].name, name, ASSET_NAME_LENGTH) == 0) {
+            return &mIndex[i];
+        }
+    }
+    return nullptr;
+}
+
+bool AssetPack::bind(const SoundAsset* sounds, int soundCount, const TileAsset* tiles, int tileCount) const {
+    bool found = true;
+    for (int i = 0; i < soundCount; ++i) {
+        found &= bindSound(sounds[i]);
+    }
+    for (int i = 0; i < tileCount; ++i) {
+        found &= bindTile(tiles[i]);
+    }
+    return found;
+}
+
+bool AssetPack::bindSound(const SoundAsset& asset) const {
+    const AssetEntry* entry = find(AssetKind::Sound, asset.mName);
+    if (entry && !checkSound(*entry)) {
+        entry = nullptr;
+    }
+    if (entry == nullptr) {
+        // left empty, it won't play
+        *asset.mSound = SoundFile{};
+        Serial.print(F("Asset pack has no sound "));
+        Serial.println(asset.mName);
+        return false;
+    }
+
+    SoundFile& sound = *asset.mSound;
+    sound.size = entry->param0;
+    sound.data = mBase + entry->offset;
+    sound.codec = (SoundCodec)entry->format;
+    sound.rate = entry->param1 ? entry->param1 : SOUND_DEFAULT_RATE;
+    sound.silence = entry->silenceCount ? (const SoundRun*)(mBase + entry->silenceOffset) : nullptr;
+    sound.silenceCount = entry->silenceCount;
+    return true;
+}
+
+bool AssetPack::checkSound(const AssetEntry& entry) const {
+    if (entry.format > (uint8_t)SoundCodec::ImaAdpcm) {
+        return false;
+    }
+
+    // the data has to hold every sample outside the silence runs
+    const SoundRun* runs = (const SoundRun*)(mBase + entry.silenceOffset);
+    uint64_t silent = 0;
+    for (uint32_t i = 0; i < entry.silenceCount; ++i) {
+        silent += runs[i].length;
+    }
+    if (silent > entry.param0) {
+        return false;
+    }
+    const uint32_t audible = entry.param0 - (uint32_t)silent;
+    const uint32_t needed = entry.format == (uint8_t)SoundCodec::Pcm8 ? audible : (audible + 1) / 2;
+    return entry.size >= needed;
+}
+
+bool AssetPack::checkTile(const AssetEntry& entry) const {
+    if (entry.format > (uint8_t)TileCodec::Raw || entry.param0 > TILE_MAX_WIDTH || entry.param1 > UINT16_MAX) {
+        return false;
+    }
+
+    // raw tiles hold every pixel, compressed ones at least one op byte for
+    // the longest run an op can cover
+    const uint32_t pixels = entry.param0 * entry.param1;
+    if (entry.format == (uint8_t)TileCodec::Raw) {
+        return entry.size >= pixels * 2;
+    }
+    return entry.size >= (pixels + TILE_MAX_OP_PIXELS - 1) / TILE_MAX_OP_PIXELS;
+}
+
+bool AssetPack::bindTile(const TileAsset& asset) const {
+    const AssetEntry* entry = find(AssetKind::Tile, asset.mName);
+    if (entry && !checkTile(*entry)) {
+        entry = nullptr;
+    }
+    if (entry == nullptr) {
+        // left empty, it draws as black
+        *asset.mTile = TileBitmap{};
+        Serial.print(F("Asset pack has no tile "));
+        Serial.println(asset.mName);
+        return false;
+    }
+
+    TileBitmap& tile = *asset.mTile;
+    tile.width = (uint16_t)entry->param0;
+    tile.height = (uint16_t)entry->param1;
+    tile.size = entry->size;
+    tile.data = mBase + entry->offset;
+    tile.codec = (TileCodec)entry->format;
+    return true;
+}
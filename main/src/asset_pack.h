@@ -0,0 +1,101 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <stdint.h>
+#include "sound_file.h"
+#include "tile_bitmap.h"
+
+// Read the sounds and tiles from an asset pack in their own flash
+// partition rather than compiling them into the firmware, so they can be
+// flashed on their own. The board's default partition table has no room
+// for it: copy main/partitions_assets.csv to main/partitions.csv, where
+// the core picks it up, and flash tools/asset_pack.py's pack to its
+// "assets" partition before turning this on. See the README.
+#ifndef ASSETS_IN_PARTITION
+  #define ASSETS_IN_PARTITION 0
+#endif
+
+// the partition the pack is flashed to, and the file the host build maps
+#define ASSET_PARTITION_NAME "assets"
+#define ASSET_PARTITION_SUBTYPE 0x40
+#ifndef ASSET_PACK_PATH
+  #define ASSET_PACK_PATH "assets.bin"
+#endif
+
+// The pack layout, all little endian. A header, then the index, then the
+// data of every asset, each starting on a 4 byte boundary. Offsets are
+// from the start of the pack. See tools/asset_pack.py, which writes it.
+#define ASSET_PACK_MAGIC 0x50415444  // "DTAP"
+#define ASSET_PACK_VERSION 1
+#define ASSET_NAME_LENGTH 20
+
+enum class AssetKind : uint8_t {
+    Sound,
+    Tile,
+};
+
+struct AssetPackHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;    // index entries
+    uint32_t size;     // the whole pack, in bytes
+    uint32_t reserved;
+};
+
+struct AssetEntry {
+    char name[ASSET_NAME_LENGTH];  // zero padded, not always terminated
+    AssetKind kind;
+    uint8_t format;                // a SoundCodec or a TileCodec
+    uint16_t reserved;
+    uint32_t offset;
+    uint32_t size;                 // bytes of data
+    uint32_t param0;               // sounds: samples, tiles: width
+    uint32_t param1;               // sounds: rate, tiles: height
+    uint32_t silenceOffset;        // sounds: the SoundRun table, if any
+    uint32_t silenceCount;
+};
+
+static_assert(sizeof(AssetPackHeader) == 16, "asset pack header layout");
+static_assert(sizeof(AssetEntry) == 48, "asset pack index layout");
+
+// the asset a name in the pack fills in
+struct SoundAsset {
+    const char* mName;
+    SoundFile* mSound;
+};
+struct TileAsset {
+    const char* mName;
+    TileBitmap* mTile;
+};
+
+// An asset pack mapped into memory, from its partition on the device or
+// from a file on the host. The assets point straight into the mapping, so
+// it stays open for good once it is.
+class AssetPack {
+
+public:
+    // maps the pack and checks its index, false if it is missing or bad
+    bool open();
+    bool isOpen() const {
+        return mBase != nullptr;
+    }
+
+    const AssetEntry* find(AssetKind kind, const char* name) const;
+
+    // point every asset at its entry, an asset missing from the pack is
+    // left empty and reported; false if any were
+    bool bind(const SoundAsset* sounds, int soundCount, const TileAsset* tiles, int tileCount) const;
+
+private:
+    bool check(const uint8_t* base, uint32_t size);
+    bool checkSound(const AssetEntry& entry) const;
+    bool checkTile(const AssetEntry& entry) const;
+    bool bindSound(const SoundAsset& asset) const;
+    bool bindTile(const TileAsset& asset) const;
+
+    const uint8_t* mBase = nullptr;
+    const AssetEntry* mIndex = nullptr;
+    uint16_t mCount = 0;
+};
+
+#endif // ASSET_PACK_H
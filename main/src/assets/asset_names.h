@@ -0,0 +1,130 @@
+#include "../asset_pack.h"
+
+// generated by tools/asset_pack.py, do not edit
+// Every asset in the pack, empty until loadAssets() points them at it.
+
+SoundFile battle_snd = {};
+SoundFile bazaar_snd = {};
+SoundFile bazaar_closed_snd = {};
+SoundFile beep_snd = {};
+SoundFile clear_snd = {};
+SoundFile darktower_snd = {};
+SoundFile dragon_snd = {};
+SoundFile dragon_kill_snd = {};
+SoundFile end_turn_snd = {};
+SoundFile enemy_hit_snd = {};
+SoundFile frontier_snd = {};
+SoundFile intro_snd = {};
+SoundFile lost_snd = {};
+SoundFile pegasus_snd = {};
+SoundFile plague_snd = {};
+SoundFile player_hit_snd = {};
+SoundFile rotate_snd = {};
+SoundFile sanctuary_snd = {};
+SoundFile starving_snd = {};
+SoundFile tomb_snd = {};
+SoundFile tomb_battle_snd = {};
+SoundFile tomb_nothing_snd = {};
+SoundFile wrong_snd = {};
+
+const int sound_assets_LEN = 23;
+const SoundAsset sound_assets[23] = {
+	{ "battle", &battle_snd },
+	{ "bazaar", &bazaar_snd },
+	{ "bazaar_closed", &bazaar_closed_snd },
+	{ "beep", &beep_snd },
+	{ "clear", &clear_snd },
+	{ "darktower", &darktower_snd },
+	{ "dragon", &dragon_snd },
+	{ "dragon_kill", &dragon_kill_snd },
+	{ "end_turn", &end_turn_snd },
+	{ "enemy_hit", &enemy_hit_snd },
+	{ "frontier", &frontier_snd },
+	{ "intro", &intro_snd },
+	{ "lost", &lost_snd },
+	{ "pegasus", &pegasus_snd },
+	{ "plague", &plague_snd },
+	{ "player_hit", &player_hit_snd },
+	{ "rotate", &rotate_snd },
+	{ "sanctuary", &sanctuary_snd },
+	{ "starving", &starving_snd },
+	{ "tomb", &tomb_snd },
+	{ "tomb_battle", &tomb_battle_snd },
+	{ "tomb_nothing", &tomb_nothing_snd },
+	{ "wrong", &wrong_snd }
+};
+
+TileBitmap tile_bitmap_bazaar = {};
+TileBitmap tile_bitmap_beast = {};
+TileBitmap tile_bitmap_brasskey = {};
+TileBitmap tile_bitmap_brigands = {};
+TileBitmap tile_bitmap_cursed = {};
+TileBitmap tile_bitmap_dragon = {};
+TileBitmap tile_bitmap_food = {};
+TileBitmap tile_bitmap_gold = {};
+TileBitmap tile_bitmap_goldkey = {};
+TileBitmap tile_bitmap_healer = {};
+TileBitmap tile_bitmap_keymissing = {};
+TileBitmap tile_bitmap_logo = {};
+TileBitmap tile_bitmap_lost = {};
+TileBitmap tile_bitmap_pegasus = {};
+TileBitmap tile_bitmap_plague = {};
+TileBitmap tile_bitmap_scout = {};
+TileBitmap tile_bitmap_silverkey = {};
+TileBitmap tile_bitmap_sword = {};
+TileBitmap tile_bitmap_victory = {};
+TileBitmap tile_bitmap_warrior = {};
+TileBitmap tile_bitmap_warriors = {};
+TileBitmap tile_bitmap_wizard = {};
+
+const int tile_bitmap_allArray_LEN = 22;
+const TileBitmap* tile_bitmap_allArray[22] = {
+	&tile_bitmap_bazaar,
+	&tile_bitmap_beast,
+	&tile_bitmap_brasskey,
+	&tile_bitmap_brigands,
+	&tile_bitmap_cursed,
+	&tile_bitmap_dragon,
+	&tile_bitmap_food,
+	&tile_bitmap_gold,
+	&tile_bitmap_goldkey,
+	&tile_bitmap_healer,
+	&tile_bitmap_keymissing,
+	&tile_bitmap_logo,
+	&tile_bitmap_lost,
+	&tile_bitmap_pegasus,
+	&tile_bitmap_plague,
+	&tile_bitmap_scout,
+	&tile_bitmap_silverkey,
+	&tile_bitmap_sword,
+	&tile_bitmap_victory,
+	&tile_bitmap_warrior,
+	&tile_bitmap_warriors,
+	&tile_bitmap_wizard
+};
+
+const int tile_assets_LEN = 22;
+const TileAsset tile_assets[22] = {
+	{ "bazaar", &tile_bitmap_bazaar },
+	{ "beast", &tile_bitmap_beast },
+	{ "brasskey", &tile_bitmap_brasskey },
+	{ "brigands", &tile_bitmap_brigands },
+	{ "cursed", &tile_bitmap_cursed },
+	{ "dragon", &tile_bitmap_dragon },
+	{ "food", &tile_bitmap_food },
+	{ "gold", &tile_bitmap_gold },
+	{ "goldkey", &tile_bitmap_goldkey },
+	{ "healer", &tile_bitmap_healer },
+	{ "keymissing", &tile_bitmap_keymissing },
+	{ "logo", &tile_bitmap_logo },
+	{ "lost", &tile_bitmap_lost },
+	{ "pegasus", &tile_bitmap_pegasus },
+	{ "plague", &tile_bitmap_plague },
+	{ "scout", &tile_bitmap_scout },
+	{ "silverkey", &tile_bitmap_silverkey },
+	{ "sword", &tile_bitmap_sword },
+	{ "victory", &tile_bitmap_victory },
+	{ "warrior", &tile_bitmap_warrior },
+	{ "warriors", &tile_bitmap_warriors },
+	{ "wizard", &tile_bitmap_wizard }
+};
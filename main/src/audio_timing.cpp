@@ -0,0 +1,144 @@
+#include <Arduino.h>
+#include <algorithm>
+#include "audio_timing.h"
+#include "sound_manager.h"
+
+void AudioTimingCounters::tick(int64_t now, bool displayBusy) {
+    bump(mTicks);
+    const int64_t last = mLastTick;
+    mLastTick = now;
+    if (last == 0) {
+        return;
+    }
+
+    const int64_t period = now - last;
+    const uint32_t jitter = (uint32_t)std::min<int64_t>(std::abs(period - SOUND_SAMPLE_PERIOD_US), UINT32_MAX);
+    int bucket = 0;
+    while (bucket < AUDIO_JITTER_BUCKETS - 1 && jitter >= (1u << (bucket + AUDIO_JITTER_FIRST_SHIFT))) {
+        ++bucket;
+    }
+    bump(mJitter[bucket]);
+    raise(mWorstJitterUs, jitter);
+
+    // every whole period past the first held the last sample too long
+    const uint32_t periods = (uint32_t)((period + SOUND_SAMPLE_PERIOD_US / 2) / SOUND_SAMPLE_PERIOD_US);
+    if (periods > 1) {
+        bump(mMissedSamples, periods - 1);
+        if (displayBusy) {
+            bump(mMissedInDisplay, periods - 1);
+        }
+    }
+}
+
+void AudioTimingCounters::tickDone(int64_t start, int64_t end) {
+    raise(mWorstTickUs, (uint32_t)(end - start));
+}
+
+void AudioTimingCounters::mixed(uint32_t us) {
+    bump(mBlocks);
+    bump(mMixTotalUs, us);
+    raise(mWorstMixUs, us);
+}
+
+void AudioTimingCounters::lead(int64_t us, bool displayBusy) {
+    if (us < 0) {
+        bump(mUnderruns);
+        if (displayBusy) {
+            bump(mUnderrunsInDisplay);
+        }
+        us = 0;
+    }
+    const uint32_t lead = (uint32_t)std::min<int64_t>(us, UINT32_MAX);
+    if (lead < mLeastLeadUs.load(std::memory_order_relaxed)) {
+        mLeastLeadUs.store(lead, std::memory_order_relaxed);
+    }
+}
+
+void AudioTimingCounters::commandWait(uint32_t us) {
+    bump(mCommandWaits);
+    bump(mCommandWaitUs, us);
+}
+
+AudioTiming AudioTimingCounters::snapshot() const {
+    AudioTiming timing;
+    timing.mTicks = mTicks.load(std::memory_order_relaxed);
+    for (int i = 0; i < AUDIO_JITTER_BUCKETS; ++i) {
+        timing.mJitter[i] = mJitter[i].load(std::memory_order_relaxed);
+    }
+    timing.mWorstJitterUs = mWorstJitterUs.load(std::memory_order_relaxed);
+    timing.mWorstTickUs = mWorstTickUs.load(std::memory_order_relaxed);
+    timing.mMissedSamples = mMissedSamples.load(std::memory_order_relaxed);
+    timing.mMissedInDisplay = mMissedInDisplay.load(std::memory_order_relaxed);
+    timing.mUnderruns = mUnderruns.load(std::memory_order_relaxed);
+    timing.mUnderrunsInDisplay = mUnderrunsInDisplay.load(std::memory_order_relaxed);
+    timing.mLeastLeadUs = mLeastLeadUs.load(std::memory_order_relaxed);
+    timing.mBlocks = mBlocks.load(std::memory_order_relaxed);
+    timing.mMixTotalUs = mMixTotalUs.load(std::memory_order_relaxed);
+    timing.mWorstMixUs = mWorstMixUs.load(std::memory_order_relaxed);
+    timing.mCommandWaits = mCommandWaits.load(std::memory_order_relaxed);
+    timing.mCommandWaitUs = mCommandWaitUs.load(std::memory_order_relaxed);
+    return timing;
+}
+
+AudioTiming AudioTiming::since(const AudioTiming& earlier) const {
+    AudioTiming delta = *this;
+    delta.mTicks -= earlier.mTicks;
+    for (int i = 0; i < AUDIO_JITTER_BUCKETS; ++i) {
+        delta.mJitter[i] -= earlier.mJitter[i];
+    }
+    delta.mMissedSamples -= earlier.mMissedSamples;
+    delta.mMissedInDisplay -= earlier.mMissedInDisplay;
+    delta.mUnderruns -= earlier.mUnderruns;
+    delta.mUnderrunsInDisplay -= earlier.mUnderrunsInDisplay;
+    delta.mBlocks -= earlier.mBlocks;
+    delta.mMixTotalUs -= earlier.mMixTotalUs;
+    delta.mCommandWaits -= earlier.mCommandWaits;
+    delta.mCommandWaitUs -= earlier.mCommandWaitUs;
+    return delta;
+}
+
+void AudioTiming::dump(Print& out) const {
+    out.print(F("Ticks: "));
+    out.print(mTicks);
+    out.print(F(", missed samples: "));
+    out.print(mMissedSamples);
+    out.print(F(" ("));
+    out.print(mMissedInDisplay);
+    out.print(F(" in display update), worst jitter us: "));
+    out.print(mWorstJitterUs);
+    out.print(F(", worst tick us: "));
+    out.println(mWorstTickUs);
+
+    out.print(F("Jitter us:"));
+    for (int i = 0; i < AUDIO_JITTER_BUCKETS; ++i) {
+        out.print(i < AUDIO_JITTER_BUCKETS - 1 ? F(" <") : F(" >="));
+        out.print(1u << (i + AUDIO_JITTER_FIRST_SHIFT - (i < AUDIO_JITTER_BUCKETS - 1 ? 0 : 1)));
+        out.print(':');
+        out.print(mJitter[i]);
+    }
+    out.println();
+
+    out.print(F("Blocks: "));
+    out.print(mBlocks);
+    out.print(F(", average mix us: "));
+    out.print(mBlocks ? mMixTotalUs / mBlocks : 0);
+    out.print(F(", worst mix us: "));
+    out.println(mWorstMixUs);
+
+    out.print(F("Underruns: "));
+    out.print(mUnderruns);
+    out.print(F(" ("));
+    out.print(mUnderrunsInDisplay);
+    out.print(F(" in display update), least lead us: "));
+    if (mLeastLeadUs == UINT32_MAX) {
+        out.println(F("-"));
+    }
+    else {
+        out.println(mLeastLeadUs);
+    }
+
+    out.print(F("Command waits: "));
+    out.print(mCommandWaits);
+    out.print(F(", us: "));
+    out.println(mCommandWaitUs);
+}
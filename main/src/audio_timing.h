@@ -0,0 +1,105 @@
+#ifndef AUDIO_TIMING_H
+#define AUDIO_TIMING_H
+
+#include <stdint.h>
+#include <atomic>
+#include <Arduino.h>
+
+// Measure the audio path as it runs. Costs a clock read per timer tick,
+// so it can be compiled out.
+#ifndef SOUND_TIMING_STATS
+  #define SOUND_TIMING_STATS 1
+#endif
+
+// timer ticks by how far they were off the period: under 8us, 16us, and
+// so on doubling, with the last bucket 512us and over
+#define AUDIO_JITTER_BUCKETS 8
+#define AUDIO_JITTER_FIRST_SHIFT 3
+
+// A copy of the audio timing counters, taken from the main loop. Counts
+// run from power on; subtract an earlier copy to get an interval.
+struct AudioTiming {
+    // timer path
+    uint32_t mTicks = 0;
+    uint32_t mJitter[AUDIO_JITTER_BUCKETS] = {};
+    uint32_t mWorstJitterUs = 0;
+    uint32_t mWorstTickUs = 0;        // longest callback
+    uint32_t mMissedSamples = 0;      // periods that went by without a tick
+    uint32_t mMissedInDisplay = 0;    // of those, while the display updated
+
+    // DMA path
+    uint32_t mUnderruns = 0;          // the DAC ran dry before the next block
+    uint32_t mUnderrunsInDisplay = 0;
+    uint32_t mLeastLeadUs = 0;        // closest the DAC came to running dry
+
+    // both paths
+    uint32_t mBlocks = 0;             // blocks mixed
+    uint32_t mMixTotalUs = 0;
+    uint32_t mWorstMixUs = 0;
+
+    // game side, play() or stop() finding the command ring full
+    uint32_t mCommandWaits = 0;
+    uint32_t mCommandWaitUs = 0;
+
+    // counts since earlier, the worst cases are kept as they are
+    AudioTiming since(const AudioTiming& earlier) const;
+    void dump(Print& out) const;
+};
+
+// The live counters. Every counter has a single writer, the audio side
+// except for the command waits, so they are updated with a plain load
+// and store rather than a read-modify-write, which the ESP32-S2 can only
+// do with interrupts off. Reading a snapshot takes no lock either; a
+// snapshot can be a tick out between two counters, never torn within one.
+class AudioTimingCounters {
+
+public:
+    // audio side, timer path: one call per tick. A tick after a gap the
+    // audio side expected (idle or parked) starts over with restart.
+    void tick(int64_t now, bool displayBusy);
+    void restart() {
+        mLastTick = 0;
+    }
+    void tickDone(int64_t start, int64_t end);
+
+    // audio side, both paths
+    void mixed(uint32_t us);
+    // audio side, DMA path: how far ahead of the DAC a block was written,
+    // negative if it had already run dry
+    void lead(int64_t us, bool displayBusy);
+
+    // game side
+    void commandWait(uint32_t us);
+
+    AudioTiming snapshot() const;
+
+private:
+    static void bump(std::atomic<uint32_t>& counter, uint32_t count = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + count, std::memory_order_relaxed);
+    }
+    static void raise(std::atomic<uint32_t>& worst, uint32_t value) {
+        if (value > worst.load(std::memory_order_relaxed)) {
+            worst.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    // only touched by the audio side
+    int64_t mLastTick = 0;
+
+    std::atomic<uint32_t> mTicks{0};
+    std::atomic<uint32_t> mJitter[AUDIO_JITTER_BUCKETS] = {};
+    std::atomic<uint32_t> mWorstJitterUs{0};
+    std::atomic<uint32_t> mWorstTickUs{0};
+    std::atomic<uint32_t> mMissedSamples{0};
+    std::atomic<uint32_t> mMissedInDisplay{0};
+    std::atomic<uint32_t> mUnderruns{0};
+    std::atomic<uint32_t> mUnderrunsInDisplay{0};
+    std::atomic<uint32_t> mLeastLeadUs{UINT32_MAX};
+    std::atomic<uint32_t> mBlocks{0};
+    std::atomic<uint32_t> mMixTotalUs{0};
+    std::atomic<uint32_t> mWorstMixUs{0};
+    std::atomic<uint32_t> mCommandWaits{0};
+    std::atomic<uint32_t> mCommandWaitUs{0};
+};
+
+#endif // AUDIO_TIMING_H
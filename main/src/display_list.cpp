@@ -0,0 +1,263 @@
+#include "display_list.h"
+#include "display_manager.h"
+
+static int16_t centeredInset(const String& text, const GFXfont* font) {
+    int16_t inset = 120 - (DisplayManager::measureText(text, font) >> 1);
+    return inset < 0 ? 0 : inset;
+}
+
+void DisplayList::compile(const ScreenLayout& layout,
+    const GFXfont* titleFont, const GFXfont* textFont)
+{
+    mLayout = layout;
+    mLayout.mSelection = 0;
+    mCompiled = true;
+    mOps.clear();
+    mFirstOptionOp = 0;
+    mLinesAvailable = 0;
+    mOptionRows = 0;
+    mScrollTop = 0;
+    mScrollHeight = 0;
+
+    int VertPos= 0;
+
+    // Title
+    if (layout.mTitle.length() != 0) {
+        // descenders reach past the title into the gap left when there is
+        // no bitmap, so the title owns that gap too
+        const int16_t bottom = VertPos + (layout.mBitmap != nullptr ? 32 : 48);
+        mOps.push_back({DrawOp::Title, 0, centeredInset(layout.mTitle, titleFont),
+            (int16_t)(VertPos + 27), (int16_t)VertPos, bottom, ST77XX_WHITE, 0});
+        VertPos += 32;
+    }
+
+    // bitmaps
+    if (layout.mBitmap != nullptr) {
+        mOps.push_back({DrawOp::Bitmap, 0, 0,
+            (int16_t)VertPos, (int16_t)VertPos, (int16_t)(VertPos + 180), 0, 0});
+        VertPos += 180;
+    }
+    else {
+        VertPos += 16;
+    }
+
+    // information
+    for (size_t i=0; i<layout.mTextLines.size(); ++i) {
+        if (VertPos < 320 - SMALL_LINE_HEIGHT) {
+            const TextLine& line = layout.mTextLines[i];
+            mOps.push_back({DrawOp::Text, 0, centeredInset(line.mText, textFont),
+                (int16_t)(VertPos + 21), (int16_t)(VertPos + TEXT_BAND_INSET),
+                (int16_t)(VertPos + TEXT_BAND_INSET + SMALL_LINE_HEIGHT), line.mValue, (int16_t)i});
+            VertPos += SMALL_LINE_HEIGHT;
+        }
+    }
+    VertPos += 4; // add some buffer for decendant font elements on the last line
+
+    // options
+    mFirstOptionOp = mOps.size();
+    const int hasOptions = layout.mOptions.size();
+    if (hasOptions == 0) {
+        return;
+    }
+
+    mLinesAvailable = (320 - VertPos) / SMALL_LINE_HEIGHT;
+    if (mLinesAvailable > hasOptions) {
+        int delta = mLinesAvailable - hasOptions; 
+        VertPos += (delta * SMALL_LINE_HEIGHT) >> 1; 
+    }
+
+    // every option gets an op at its row in a list starting at the top,
+    // place() moves them into the visible window
+    const int optionsTop = VertPos;
+    for (int i=0; i<hasOptions; ++i) {
+        if (VertPos < 320 - SMALL_LINE_HEIGHT) {
+            ++mOptionRows;
+        }
+        mOps.push_back({DrawOp::Option, 0, centeredInset(layout.mOptions[i].mText, textFont),
+            (int16_t)(VertPos + 21), (int16_t)(VertPos + TEXT_BAND_INSET),
+            (int16_t)(VertPos + TEXT_BAND_INSET + SMALL_LINE_HEIGHT), ST77XX_WHITE, (int16_t)i});
+        VertPos += SMALL_LINE_HEIGHT;
+    }
+
+    // a list longer than the screen can scroll through the visible bands
+    const int scrollTop = optionsTop + TEXT_BAND_INSET;
+    const int scrollHeight = mOptionRows * SMALL_LINE_HEIGHT;
+    if (hasOptions > mOptionRows && scrollTop + scrollHeight <= 320) {
+        mScrollTop = scrollTop;
+        mScrollHeight = scrollHeight;
+    }
+}
+
+bool DisplayList::matches(const ScreenLayout& layout) const {
+    return mCompiled
+        && mLayout.mTitle == layout.mTitle
+        && mLayout.mBitmap == layout.mBitmap
+        && mLayout.mTextLines == layout.mTextLines
+        && mLayout.mOptions == layout.mOptions;
+}
+
+int DisplayList::placeStartLine(int selection, int startLine) const {
+    const int hasOptions = mLayout.mOptions.size();
+    if (hasOptions == 0) {
+        return 0;
+    }
+
+    // keep the selection and one line either side of it in view
+    const int lastLine = hasOptions - 1;
+    const int buffer= mLinesAvailable > 2 ? 1 : 0;
+
+    int minVisible = selection - buffer;
+    if (minVisible < 0) {
+        minVisible = 0;
+    }
+    if (minVisible < startLine) {
+        startLine = minVisible;
+    }
+
+    int maxVisible = selection + buffer;
+    if (maxVisible > lastLine) {
+        maxVisible = lastLine;
+    }
+    int proposedStart = maxVisible - (mLinesAvailable-1);
+    if (proposedStart > startLine) {
+        startLine = proposedStart;
+    }
+    if (startLine < 0)  {
+        startLine = 0;
+    }
+    return startLine;
+}
+
+void DisplayList::place(int selection, int startLine, std::vector<DrawOp>& ops) const {
+    ops.assign(mOps.begin(), mOps.begin() + mFirstOptionOp);
+    DrawOp op;
+    for (int i = startLine; i < startLine + mOptionRows; ++i) {
+        if (placeOption(i, selection, startLine, op)) {
+            ops.push_back(op);
+        }
+    }
+}
+
+bool DisplayList::placeOption(int option, int selection, int startLine, DrawOp& op) const {
+    const int row = option - startLine;
+    if (row < 0 || row >= mOptionRows || option >= (int)mLayout.mOptions.size()) {
+        return false;
+    }
+    op = mOps[mFirstOptionOp + option];
+    const int16_t shift = startLine * SMALL_LINE_HEIGHT;
+    op.mY -= shift;
+    op.mTop -= shift;
+    op.mBottom -= shift;
+    if (option == selection && mLayout.mOptions[option].mText.length() > 0) {
+        op.mFlags |= DrawOp::Selected;
+        op.mColor = ST77XX_YELLOW;
+    }
+    return true;
+}
+
+const String& DisplayList::getText(const DrawOp& op) const {
+    static String NONE;
+    switch (op.mType) {
+        case DrawOp::Title:
+            return mLayout.mTitle;
+        case DrawOp::Text:
+            return mLayout.mTextLines[op.mIndex].mText;
+        case DrawOp::Option:
+            return mLayout.mOptions[op.mIndex].mText;
+        default:
+            break;
+    }
+    return NONE;
+}
+
+bool DisplayList::isSame(const DrawOp& op, const DisplayList& other, const DrawOp& otherOp) const {
+    if (op.mType != otherOp.mType
+        || op.mFlags != otherOp.mFlags
+        || op.mX != otherOp.mX
+        || op.mY != otherOp.mY
+        || op.mTop != otherOp.mTop
+        || op.mBottom != otherOp.mBottom
+        || op.mColor != otherOp.mColor) {
+        return false;
+    }
+    if (op.mType == DrawOp::Bitmap) {
+        return mLayout.mBitmap == other.mLayout.mBitmap;
+    }
+    return getText(op) == other.getText(otherOp);
+}
+
+bool DisplayList::isRecolor(const DrawOp& op, const DisplayList& other, const DrawOp& otherOp) const {
+    return op.mType == otherOp.mType
+        && op.mType != DrawOp::Bitmap
+        && op.mX == otherOp.mX
+        && op.mY == otherOp.mY
+        && getText(op) == other.getText(otherOp);
+}
+
+void DisplayList::diff(const DisplayList& shown, const std::vector<DrawOp>& shownOps,
+    const std::vector<DrawOp>& ops, FrameDelta& delta) const
+{
+    // pair each new op with the old op that owned the same rows
+    delta.mActions.assign(ops.size(), FrameDelta::Draw);
+    delta.mReused.assign(shownOps.size(), false);
+    for (size_t j=0; j<ops.size(); ++j) {
+        const DrawOp& op = ops[j];
+        for (size_t i=0; i<shownOps.size(); ++i) {
+            const DrawOp& old = shownOps[i];
+            if (delta.mReused[i] || old.mType != op.mType || old.mTop != op.mTop || old.mBottom != op.mBottom) {
+                continue;
+            }
+            if (isSame(op, shown, old)) {
+                delta.mActions[j] = FrameDelta::Keep;
+                delta.mReused[i] = true;
+            }
+            else if (isRecolor(op, shown, old)) {
+                // the same text drawn again covers exactly the same pixels
+                const bool unselected = (old.mFlags & DrawOp::Selected) && !(op.mFlags & DrawOp::Selected);
+                delta.mActions[j] = unselected ? FrameDelta::Unselect : FrameDelta::Recolor;
+                delta.mReused[i] = true;
+            }
+            break;
+        }
+    }
+}
+
+void DisplayList::dump(Print& out, const std::vector<DrawOp>& ops) const {
+    static const char* OpNames[] = { "title", "bitmap", "text", "option" };
+
+    out.print(F("display list: "));
+    out.print((int)ops.size());
+    out.print(F(" ops, "));
+    out.print(mOptionRows);
+    out.print(F(" option rows"));
+    if (mScrollHeight > 0) {
+        out.print(F(", scrolls rows "));
+        out.print((int)mScrollTop);
+        out.print(F("-"));
+        out.print((int)(mScrollTop + mScrollHeight));
+    }
+    out.println();
+
+    for (const DrawOp& op : ops) {
+        out.print(OpNames[op.mType]);
+        out.print(F(" x="));
+        out.print((int)op.mX);
+        out.print(F(" y="));
+        out.print((int)op.mY);
+        out.print(F(" rows="));
+        out.print((int)op.mTop);
+        out.print(F("-"));
+        out.print((int)op.mBottom);
+        if (op.mType != DrawOp::Bitmap) {
+            out.print(F(" color=0x"));
+            out.print((int)op.mColor, HEX);
+            if (op.mFlags & DrawOp::Selected) {
+                out.print(F(" selected"));
+            }
+            out.print(F(" \""));
+            out.print(getText(op));
+            out.print(F("\""));
+        }
+        out.println();
+    }
+}
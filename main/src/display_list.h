@@ -0,0 +1,118 @@
+#ifndef DISPLAY_LIST_H
+#define DISPLAY_LIST_H
+
+#include <Adafruit_GFX.h>
+#include <vector>
+#include "screen_layout.h"
+
+#define SMALL_LINE_HEIGHT 23
+
+// Text ink runs from 4 to 27 pixels below each line's position, so every
+// line owns the band starting 4 rows down. Bands never overlap, which lets
+// a line be cleared and redrawn without touching its neighbours.
+#define TEXT_BAND_INSET 4
+
+// A single drawing step with all of its coordinates worked out
+struct DrawOp {
+    enum Type : uint8_t {
+        Title,
+        Bitmap,
+        Text,
+        Option,
+    };
+    enum Flags : uint8_t {
+        Selected = 1,
+    };
+
+    Type mType;
+    uint8_t mFlags;
+    int16_t mX;       // left edge of the text, or of the bitmap
+    int16_t mY;       // text baseline, or the top of the bitmap
+    int16_t mTop;     // rows owned by the op, cleared before a redraw
+    int16_t mBottom;
+    uint16_t mColor;
+    int16_t mIndex;   // text line or option index in the layout
+};
+
+// How each placed op of a frame gets on screen from the ops of the frame
+// before, paired by the rows they own
+struct FrameDelta {
+    enum Action : uint8_t {
+        Draw,       // rows cleared and drawn from scratch
+        Keep,       // already on screen as it is
+        Recolor,    // same text in the same place, drawn over in a new color
+        Unselect,   // a recolor that also erases the selection marker
+    };
+
+    std::vector<Action> mActions;   // one per new op
+    std::vector<bool> mReused;      // one per old op, true if a new op took its rows
+};
+
+// A ScreenLayout compiled into draw ops. Compiling does all the measuring
+// and placement up front. The selection is left out: option ops are
+// compiled for every option as if the list started at the top, and are
+// placed in the visible window and highlighted per frame, so moving the
+// selection reuses the same list. Two placed frames can be compared op by
+// op to find the least that has to be drawn to go from one to the other.
+class DisplayList {
+
+public:
+    void compile(const ScreenLayout& layout,
+        const GFXfont* titleFont, const GFXfont* textFont);
+
+    // true if compile() was last called with a layout showing the same
+    // content, whatever its selection
+    bool matches(const ScreenLayout& layout) const;
+
+    const ScreenLayout& getLayout() const {
+        return mLayout;
+    }
+    const std::vector<DrawOp>& getOps() const {
+        return mOps;
+    }
+    int16_t getScrollTop() const {
+        return mScrollTop;
+    }
+    int16_t getScrollHeight() const {
+        return mScrollHeight;
+    }
+
+    // the first option in view, moved on from startLine only as far as it
+    // takes to keep the selection and one line either side of it in view
+    int placeStartLine(int selection, int startLine) const;
+    // the ops on screen with the options from startLine in view and one of
+    // them selected, option ops moved to their rows and highlighted
+    void place(int selection, int startLine, std::vector<DrawOp>& ops) const;
+    // one option's op placed the same way, false when it is out of view
+    bool placeOption(int option, int selection, int startLine, DrawOp& op) const;
+
+    const String& getText(const DrawOp& op) const;
+
+    // pairs the ops placed from this list with the ops on screen, placed
+    // from shown, and works out what each new op needs
+    void diff(const DisplayList& shown, const std::vector<DrawOp>& shownOps,
+        const std::vector<DrawOp>& ops, FrameDelta& delta) const;
+
+    void dump(Print& out) const {
+        dump(out, mOps);
+    }
+    // prints ops compiled or placed from this list
+    void dump(Print& out, const std::vector<DrawOp>& ops) const;
+
+private:
+    // same op drawing the same content in the same place
+    bool isSame(const DrawOp& op, const DisplayList& other, const DrawOp& otherOp) const;
+    // same text in the same place, only the color or selection differs
+    bool isRecolor(const DrawOp& op, const DisplayList& other, const DrawOp& otherOp) const;
+
+    ScreenLayout mLayout;
+    bool mCompiled = false;
+    int mFirstOptionOp = 0;
+    int mLinesAvailable = 0;
+    int mOptionRows = 0;
+    int16_t mScrollTop = 0;
+    int16_t mScrollHeight = 0;
+    std::vector<DrawOp> mOps;
+};
+
+#endif // DISPLAY_LIST_H
@@ -3,7 +3,30 @@
 #include "assets/SerifGothicStd_Bold12pt7b.h"
 #include "assets/SerifGothicStd_Bold20pt7b.h"
 
-#define SMALL_LINE_HEIGHT 23
+// source rows of a tile drawn per render job
+#define BITMAP_BAND_ROWS 10
+
+#define ST7789_VSCRDEF  0x33 // vertical scrolling definition
+#define ST7789_VSCRSADD 0x37 // vertical scrolling start address
+
+// double each source pixel horizontally into dst
+static inline void upscaleRow2X(uint16_t* dst, const uint16_t* srcColors, int16_t w) {
+    if (((uintptr_t)dst & 3) == 0) {
+        // write each doubled pair as one 32-bit word
+        uint32_t* dst32 = (uint32_t*)dst;
+        for (int src=0; src<w ; ++src) {
+            const uint32_t color = *srcColors++;
+            dst32[src] = color | (color << 16);
+        }
+        return;
+    }
+    for (int src=0; src<w ; ++src) {
+        int d= src*2;
+        dst[d] = *srcColors;
+        dst[d+1] = *srcColors;
+        ++srcColors;
+    }
+}
 
 void DisplayManager::setup() {
     // use this initializer (uncomment) if using a 2.0" 320x240 TFT:
@@ -15,73 +38,95 @@ void DisplayManager::setup() {
     // may end up with a black screen some times, or all the time.
     tft.setSPISpeed(40000000);
 
-    // we'll use the same font everywhere
-    tft.setFont(&SerifGothicStd_Bold12pt7b);
-    tft.setTextWrap(false);
-
     // clear the screen
     tft.fillScreen(ST77XX_BLACK);      
 
+#if DISPLAY_USE_CANVAS
+    // fall back to drawing straight to the panel if the frame won't fit
+    if (mCanvas.begin()) {
+        mGfx = &mCanvas;
+    }
+#endif
+
+    // text drawn into the canvas is already cheap, only burst to the panel
+    if (!isUsingCanvas()) {
+        mGlyphStrip.begin();
+    }
+
+    // we'll use the same font everywhere
+    setFont(&SerifGothicStd_Bold12pt7b);
+    mGfx->setTextWrap(false);
+
     setTitle("Booting");
 }
 
 void DisplayManager::drawRGBBitmap(
     int16_t x, int16_t y, 
-    const uint16_t *pcolors) 
+    const TileBitmap *tile) 
 {
-    tft.drawRGBBitmap(x, y, pcolors, 120, 90);
+    static uint16_t row[TILE_MAX_WIDTH];
+    TileDecoder decoder(*tile);
+    for (int16_t line = 0; line < tile->height; ++line) {
+        decoder.decodeRow(row);
+        mGfx->drawRGBBitmap(x, y + line, row, tile->width, 1);
+    }
 }
 
 void DisplayManager::drawRGBBitmap2X(
     int16_t x, int16_t y, 
-    const uint16_t *pcolors) 
+    const TileBitmap *tile) 
 {
-    int16_t w = 120;
-    int16_t h = 90;
-    int16_t _width = tft.width() >> 1;
-    int16_t _height = tft.height() >> 1;
-    static uint16_t scanline[320];
-    int16_t x2, y2;                 // Lower-right coord
-    if ((x >= _width) ||            // Off-edge right
-        (y >= _height) ||           // " top
-        ((x2 = (x + w - 1)) < 0) || // " left
-        ((y2 = (y + h - 1)) < 0))
-        return; // " bottom
-
-    int16_t bx1 = 0, by1 = 0, // Clipped top-left within bitmap
-        saveW = w;            // Save original bitmap width value
-    if (x < 0) {              // Clip left
-        w += x;
-        bx1 = -x;
-        x = 0;
-    }
-    if (y < 0) { // Clip top
-        h += y;
-        by1 = -y;
-        y = 0;
-    }
-    if (x2 >= _width)
-        w = _width - x; // Clip right
-    if (y2 >= _height)
-        h = _height - y; // Clip bottom
-
-    pcolors += (by1 * saveW + bx1 + 1); // Offset bitmap ptr to clipped top-left
+    TileDecoder decoder(*tile);
+    drawRGBBitmap2XRows(x, y, tile, decoder, tile->height);
+}
+
+void DisplayManager::drawRGBBitmap2XRows(
+    int16_t x, int16_t y, 
+    const TileBitmap *tile, TileDecoder& decoder, int16_t rows) 
+{
+    // clip right and bottom, layouts never place tiles above or left of the panel
+    int16_t w = std::min<int16_t>(tile->width, (tft.width() - x) >> 1);
+    int16_t h = std::min<int16_t>(rows, (tft.height() - y) >> 1);
+    if (x < 0 || y < 0 || w <= 0 || h <= 0) {
+        decoder.skipRows(rows);
+        return;
+    }
+    const int16_t clippedRows = rows - h;
+
+    // Tiles are decoded a row at a time. Rows come out already in panel
+    // byte order, so nothing is swapped on the way to the panel.
+    static uint16_t row[TILE_MAX_WIDTH];
+    const uint16_t *pcolors = row;
+
+    if (isUsingCanvas()) {
+        // upscale straight into the frame, the flush decides what gets sent
+        mCanvas.markDirty(x, y, w*2, h*2);
+        for (int16_t line = 0; line < h; ++line) {
+            uint16_t* dst = mCanvas.getRow(y + line*2) + x;
+            decoder.decodeRow(row, true);
+            upscaleRow2X(dst, pcolors, w);
+            memcpy(mCanvas.getRow(y + line*2 + 1) + x, dst, w * 2 * sizeof(uint16_t));
+        }
+        decoder.skipRows(clippedRows);
+        return;
+    }
+
     tft.startWrite();
     tft.setAddrWindow(x, y, w*2, h*2); // Clipped area
 
+    // The buffer holds both output rows for one source row, so a row pair
+    // goes out in a single transfer. On the ESP32 Adafruit_SPITFT writes
+    // through the Arduino SPI driver, which blocks until the bytes are out,
+    // so there is no DMA to overlap the next row's upscale with.
+    alignas(4) static uint16_t scanline[480];
     while (h--) {              // For each (clipped) scanline...
-        const uint16_t *srcColors = pcolors;
-        for (int src=0; src<w ; ++src) {
-            int d= src*2;
-            scanline[d] = *srcColors;
-            scanline[d+1] = *srcColors;
-            ++srcColors;
-        }
-        tft.writePixels(scanline, w*2); // Push one (clipped) row
-        tft.writePixels(scanline, w*2); // Push one (clipped) row
-        pcolors += saveW;        // Advance pointer by one full (unclipped) line
+        decoder.decodeRow(row, true);
+        upscaleRow2X(scanline, pcolors, w);
+        memcpy(scanline + w*2, scanline, w*2*sizeof(uint16_t));
+        tft.writePixels(scanline, w*4, true, true); // Push two (clipped) rows
     }
     tft.endWrite();
+    decoder.skipRows(clippedRows);
 } 
 
 void DisplayManager::setTitle(const String& title) {
@@ -91,10 +136,10 @@ String DisplayManager::getTitle() const {
     return mDesiredLayout.mTitle;
 }
 
-void DisplayManager::setBitmapsAndValues(const uint16_t* primaryBitmap, const uint16_t* secondaryBitmap) {
+void DisplayManager::setBitmapsAndValues(const TileBitmap* primaryBitmap, const TileBitmap* /*secondaryBitmap*/) {
     mDesiredLayout.mBitmap = primaryBitmap;
 }
-void DisplayManager::setBitmapAndValue(const uint16_t* primaryBitmap, int value) {
+void DisplayManager::setBitmapAndValue(const TileBitmap* primaryBitmap, int /*value*/) {
     mDesiredLayout.mBitmap = primaryBitmap;
 }
 void DisplayManager::clearBitmaps() {
@@ -133,179 +178,476 @@ void DisplayManager::forceRepaint() {
     mForceRepaint = true;
 }
 
+void DisplayManager::setFont(const GFXfont* font) {
+    mFont = font;
+    mGfx->setFont(font);
+}
+
+int16_t DisplayManager::measureText(const String& text, const GFXfont* font) {
+    // matches how Adafruit_GFX advances the cursor with wrapping off
+    int16_t width = 0;
+    for (unsigned int i=0; i<text.length(); ++i) {
+        const uint8_t c = (uint8_t)text[i];
+        if (c >= font->first && c <= font->last) {
+            width += font->glyph[c - font->first].xAdvance;
+        }
+    }
+    return width;
+}
+
+int16_t DisplayManager::measureText(const String& text) {
+    if (mFont == nullptr) {
+        return 0;
+    }
+    for (const TextWidth& entry : mWidthCache) {
+        if (entry.mFont == mFont && entry.mText == text) {
+            return entry.mWidth;
+        }
+    }
+
+    TextWidth& entry = mWidthCache[mNextWidthSlot];
+    mNextWidthSlot = (mNextWidthSlot + 1) % mWidthCache.size();
+    entry.mFont = mFont;
+    entry.mText = text;
+    entry.mWidth = measureText(text, mFont);
+    return entry.mWidth;
+}
+
 int16_t DisplayManager::drawTextCentered(const String& text, int yPos, uint16_t color) {
-    tft.setCursor(0, yPos);
-    tft.setTextColor(ST77XX_BLACK);
-    tft.print(text);
-    int16_t endX= tft.getCursorX();
-    int16_t inset = 120 - (endX >> 1);
+    int16_t inset = 120 - (measureText(text) >> 1);
     if (inset < 0) {
         inset = 0;
     }
-    tft.setCursor(inset, yPos);
-    tft.setTextColor(color);
-    tft.print(text);
+    drawText(inset, yPos, text, color, 0, tft.height());
 
     return inset;
 }
 
-void DisplayManager::update() {
-    int VertPos= 0;
-    
-    // Title
-    const bool hadTitle = mCurrentLayout.mTitle.length() > 0;
-    const bool hasTitle = mDesiredLayout.mTitle.length() > 0;
-    if (hadTitle != hasTitle) {
-        mForceRepaint= true;   
-    }
-    if (mForceRepaint || mCurrentLayout.mTitle != mDesiredLayout.mTitle) {
-        tft.fillRect(0, VertPos, 240, VertPos+32, ST77XX_BLACK);
-        tft.setFont(&SerifGothicStd_Bold20pt7b);
-        drawTextCentered(mDesiredLayout.mTitle, VertPos + 27, ST77XX_WHITE);	
-
-        if (mDesiredLayout.mTitle.length() != 0) {
-            VertPos += 32;  
+void DisplayManager::drawText(int16_t x, int16_t y, const String& text, uint16_t color, int16_t top, int16_t bottom) {
+    if (mGlyphStrip.isEnabled()) {
+        // send the whole string as one burst instead of pixel by pixel,
+        // kept to the rows the text owns as the strip is opaque
+        int16_t bx, by, bw, bh;
+        // glyphs are composed in panel byte order
+        const uint16_t* strip = mGlyphStrip.composeString(mFont, text, x, y, top, bottom,
+            __builtin_bswap16(color), __builtin_bswap16(ST77XX_BLACK), bx, by, bw, bh);
+        if (strip && by + bh <= tft.height()) {
+            tft.startWrite();
+            tft.setAddrWindow(bx, by, bw, bh);
+            tft.writePixels((uint16_t*)strip, (uint32_t)bw * bh, true, true);
+            tft.endWrite();
+            return;
         }
-        mCurrentLayout.mTitle = mDesiredLayout.mTitle;
-        mPostTitleVert = VertPos;
+    }
+    mGfx->setCursor(x, y);
+    mGfx->setTextColor(color);
+    mGfx->print(text);
+}
+
+void DisplayManager::addJob(RenderJob::Type type, int16_t y, int16_t height, int16_t index, uint8_t flags) {
+    RenderJob job;
+    job.mType = type;
+    job.mFlags = flags;
+    job.mY = y;
+    job.mHeight = height;
+    job.mIndex = index;
+    mJobs.push_back(job);
+}
+
+void DisplayManager::update() {
+    if (!isRendering()) {
+        planFrame();
+    }
+    runJobs(mRenderBudget);
+}
+
+bool DisplayManager::hasWork() const {
+    return isRendering() || mForceRepaint || mCurrentList == nullptr
+        || !mCurrentList->matches(mDesiredLayout) || mSelection != mDesiredLayout.mSelection;
+}
+
+void DisplayManager::repaint() {
+    if (!isRendering()) {
+        planFrame();
+    }
+    runJobs(UINT32_MAX);
+}
+
+void DisplayManager::planFrame() {
+    // Compiles the desired layout into a display list, places its ops for
+    // the selection and queues the jobs to get from the ops on screen to
+    // them. The new ops become current here, and the jobs draw from them,
+    // so nothing is planned again until they finish.
+    mJobs.clear();
+    mNextJob = 0;
+
+    pinSelection();
+    const DisplayList* shown = mCurrentList;
+    const int selection = mDesiredLayout.mSelection;
+    if (!mForceRepaint && shown != nullptr && shown->matches(mDesiredLayout) && mSelection == selection) {
+        return;
+    }
+    mCurrentList = findList(mDesiredLayout);
+
+    // the option list keeps its position unless it changed length
+    int startLine = 0;
+    if (shown != nullptr && shown->getLayout().mOptions.size() == mDesiredLayout.mOptions.size()) {
+        startLine = mStartLine;
+    }
+    startLine = mCurrentList->placeStartLine(selection, startLine);
+
+    const int shownStartLine = mStartLine;
+    const int shownSelection = mSelection;
+    mShownOps.swap(mOps);
+    mStartLine = startLine;
+    mSelection = selection;
+    mCurrentList->place(selection, startLine, mOps);
+
+    if (mForceRepaint || shown == nullptr) {
+        planRepaint();
     }
     else {
-        VertPos = mPostTitleVert;
+        // a list is compiled without the selection, so moving it through a
+        // long list keeps the same list and only scrolls
+        const int scrollBy = startLine - shownStartLine;
+        if (scrollBy != 0 && mCurrentList == shown && canScrollBy(scrollBy)) {
+            // only touches a couple of rows, so it is done right away
+            scrollOptions(scrollBy, shownSelection);
+            return;
+        }
+        planDelta(*shown);
     }
+    mForceRepaint = false;
 
-    // bitmaps
-    bool hadBitmaps = (mCurrentLayout.mBitmap != nullptr);
-    bool hasBitmaps = (mDesiredLayout.mBitmap != nullptr);
-    if (hasBitmaps != hadBitmaps) {
-        mForceRepaint = true;    
+    if (isUsingCanvas() && !mJobs.empty()) {
+        for (int16_t ty = 0; ty < CANVAS_TILES_Y; ++ty) {
+            addJob(RenderJob::FlushRow, 0, 0, ty);
+        }
+    }
+    if (!mJobs.empty()) {
+        mFrameFlushBytes = 0;
+        mFrameOverruns = 0;
+        mFrameWorstOverrun = 0;
     }
-    if (mForceRepaint || mCurrentLayout.mBitmap != mDesiredLayout.mBitmap) {
-        tft.fillRect(0, VertPos, 240, VertPos + (hadBitmaps * 90), ST77XX_BLACK);
-        if (hasBitmaps) {
-            drawRGBBitmap2X(0, VertPos, mDesiredLayout.mBitmap);
-            VertPos += 180;
+}
+
+const DisplayList* DisplayManager::findList(const ScreenLayout& layout) {
+    for (const DisplayList& list : mLists) {
+        if (list.matches(layout)) {
+            return &list;
         }
-		else {
-			VertPos += 16;
-		}
-        mCurrentLayout.mBitmap = mDesiredLayout.mBitmap;
-        mPostBitmapVert = VertPos;
     }
-    else {
-        VertPos = mPostBitmapVert;
+
+    // recompile the oldest slot, but never the list on screen
+    if (&mLists[mNextList] == mCurrentList) {
+        mNextList = (mNextList + 1) % mLists.size();
     }
+    DisplayList& list = mLists[mNextList];
+    mNextList = (mNextList + 1) % mLists.size();
+    list.compile(layout, &SerifGothicStd_Bold20pt7b, &SerifGothicStd_Bold12pt7b);
+    return &list;
+}
 
-    // information
-    const int hadTextLines = mCurrentLayout.mTextLines.size();
-    const int hasTextLines = mDesiredLayout.mTextLines.size();
-    if (hadTextLines != hasTextLines) {
-        mForceRepaint= true;   
+void DisplayManager::planRepaint() {
+    addJob(RenderJob::ResetScroll);
+    addJob(RenderJob::Clear, 0, 320);
+    for (size_t i=0; i<mOps.size(); ++i) {
+        addDrawJob(i);
     }
-    if (mForceRepaint || mCurrentLayout.mTextLines != mDesiredLayout.mTextLines) {
-        // clear the remaining space
-        if (VertPos < 320) {
-            tft.fillRect(0, VertPos, 240, 320, ST77XX_BLACK);
+
+    // a list longer than the screen scrolls in hardware
+    if (mCurrentList->getScrollHeight() > 0) {
+        addJob(RenderJob::ScrollArea, mCurrentList->getScrollTop(), mCurrentList->getScrollHeight());
+    }
+}
+
+static bool overlaps(const std::vector<std::pair<int16_t, int16_t>>& rows, int16_t top, int16_t bottom) {
+    for (const auto& range : rows) {
+        if (top < range.second && range.first < bottom) {
+            return true;
         }
-        mForceRepaint = true;
-
-        tft.setFont(&SerifGothicStd_Bold12pt7b);	
-        for (int i=0; i<mDesiredLayout.mTextLines.size(); ++i) {
-            if (VertPos < 320 - SMALL_LINE_HEIGHT) {
-                const TextLine& line = mDesiredLayout.mTextLines[i]; 
-                drawTextCentered(line.mText, VertPos + 21, line.mValue);	
-                VertPos += SMALL_LINE_HEIGHT;
-            }
+    }
+    return false;
+}
+
+void DisplayManager::planDelta(const DisplayList& shown) {
+    const DisplayList& next = *mCurrentList;
+    const std::vector<DrawOp>& oldOps = mShownOps;
+    const std::vector<DrawOp>& newOps = mOps;
+
+    // the selection moving is a recolor of the two options involved
+    FrameDelta delta;
+    next.diff(shown, oldOps, newOps, delta);
+    std::vector<FrameDelta::Action>& actions = delta.mActions;
+
+    // rows that get cleared, as [top, bottom)
+    std::vector<std::pair<int16_t, int16_t>> cleared;
+    const bool scrollChanged = shown.getScrollTop() != next.getScrollTop()
+        || shown.getScrollHeight() != next.getScrollHeight();
+    if (scrollChanged) {
+        addJob(RenderJob::ResetScroll);
+        if (mScrollOffset != 0) {
+            // putting the panel rows back in order leaves the scrolled
+            // bands out of place, so all of them are drawn again
+            cleared.emplace_back(mScrollTop, mScrollTop + mScrollHeight);
+        }
+    }
+    for (size_t i=0; i<oldOps.size(); ++i) {
+        if (!delta.mReused[i]) {
+            cleared.emplace_back(oldOps[i].mTop, oldOps[i].mBottom);
+        }
+    }
+    for (size_t j=0; j<newOps.size(); ++j) {
+        if (actions[j] == FrameDelta::Draw) {
+            cleared.emplace_back(newOps[j].mTop, newOps[j].mBottom);
         }
-		VertPos += 4; // add some buffer for decendant font elements on the last line
+    }
 
-        mCurrentLayout.mTextLines = mDesiredLayout.mTextLines;
-        mPostTextVert = VertPos;
+    for (size_t i=0; i<cleared.size(); ++i) {
+        bool repeated = false;
+        for (size_t k=0; k<i; ++k) {
+            repeated |= cleared[k] == cleared[i];
+        }
+        if (!repeated) {
+            addJob(RenderJob::Clear, cleared[i].first, cleared[i].second - cleared[i].first);
+        }
     }
-    else {
-        VertPos = mPostTextVert;
+
+    for (size_t j=0; j<newOps.size(); ++j) {
+        if (actions[j] != FrameDelta::Draw && overlaps(cleared, newOps[j].mTop, newOps[j].mBottom)) {
+            actions[j] = FrameDelta::Draw;
+        }
+        if (actions[j] != FrameDelta::Keep) {
+            addDrawJob(j, actions[j] == FrameDelta::Unselect ? RenderJob::EraseMarker : 0);
+        }
     }
 
-    // options
-    const int hadOptions = mCurrentLayout.mOptions.size();
-    const int hasOptions = mDesiredLayout.mOptions.size();
-    if (hadOptions != hasOptions) {
-        mForceRepaint= true;   
-        mStartLine = 0;
+    if (scrollChanged && next.getScrollHeight() > 0) {
+        addJob(RenderJob::ScrollArea, next.getScrollTop(), next.getScrollHeight());
     }
-    pinSelection();
-    if (mForceRepaint || mCurrentLayout.mOptions != mDesiredLayout.mOptions || mCurrentLayout.mSelection != mDesiredLayout.mSelection) {
-        
-        // clear the remaining space
-        if (VertPos < 320) {
-            tft.fillRect(0, VertPos, 240, 320, ST77XX_BLACK);
+}
+
+void DisplayManager::addDrawJob(int opIndex, uint8_t flags) {
+    const DrawOp& op = mOps[opIndex];
+    if (op.mType == DrawOp::Bitmap) {
+        // painted in bands so other work can run in between
+        const int16_t height = mCurrentList->getLayout().mBitmap->height;
+        for (int16_t row = 0; row < height; row += BITMAP_BAND_ROWS) {
+            addJob(RenderJob::BitmapRows, op.mY, std::min<int16_t>(BITMAP_BAND_ROWS, height - row), row);
         }
-        mForceRepaint = true;
+        return;
+    }
+    addJob(RenderJob::Op, 0, 0, opIndex, flags);
+}
 
-        if (hasOptions > 0) {
-            const int linesAvailable = (320 - VertPos) / SMALL_LINE_HEIGHT;
-            const int lastLine = hasOptions - 1;
-            const int buffer= linesAvailable > 2 ? 1 : 0;
+void DisplayManager::runJobs(uint32_t budgetUs) {
+    if (!isRendering()) {
+        return;
+    }
 
-            int minVisible = mDesiredLayout.mSelection - buffer;
-            if (minVisible < 0) {
-                minVisible = 0;
-            }
-            if (minVisible < mStartLine) {
-                mStartLine = minVisible;
-            }
-            
-            int maxVisible = mDesiredLayout.mSelection + buffer;
-            if (maxVisible > lastLine) {
-                maxVisible = lastLine;
-            }
-            int proposedStart = maxVisible - (linesAvailable-1);
-            if (proposedStart > mStartLine) {
-                mStartLine = proposedStart;
-            }
-            if (mStartLine < 0)  {
-                mStartLine = 0;
+    const uint32_t start = micros();
+    while (mNextJob < mJobs.size()) {
+        runJob(mJobs[mNextJob++]);
+
+        const uint32_t elapsed = micros() - start;
+        if (elapsed >= budgetUs) {
+            // the last job started inside the budget but ran past it
+            if (elapsed > budgetUs) {
+                ++mFrameOverruns;
+                ++mTotalOverruns;
+                mFrameWorstOverrun = std::max(mFrameWorstOverrun, elapsed - budgetUs);
             }
+            break;
+        }
+    }
+
+    if (!isRendering()) {
+        mJobs.clear();
+        mNextJob = 0;
+        if (mFrameOverruns > 0) {
+            Serial.print(F("Render budget overruns: "));
+            Serial.print((int)mFrameOverruns);
+            Serial.print(F(", worst us: "));
+            Serial.println((int)mFrameWorstOverrun);
+        }
+    }
+}
 
-            if (linesAvailable > hasOptions) {
-                int delta = linesAvailable - hasOptions; 
-                VertPos += (delta * SMALL_LINE_HEIGHT) >> 1; 
+void DisplayManager::runJob(const RenderJob& job) {
+    switch (job.mType) {
+        case RenderJob::Clear: {
+            int16_t y = job.mY;
+            if (mScrollOffset != 0 && job.mHeight <= SMALL_LINE_HEIGHT
+                && y >= mScrollTop && y + job.mHeight <= mScrollTop + mScrollHeight) {
+                // a band of the scrolled options, cleared where it is shown
+                y = toPanelRow(y);
             }
-            
-            tft.setFont(&SerifGothicStd_Bold12pt7b);
-            for (int i=mStartLine; i<mDesiredLayout.mOptions.size(); ++i) {
-                if (VertPos < 320 - SMALL_LINE_HEIGHT) {
-                    const String& line = mDesiredLayout.mOptions[i].mText;
-                    if (mDesiredLayout.mSelection == i && line.length() > 0) {
-                        int16_t inset= drawTextCentered(line, VertPos + 21, ST77XX_YELLOW);	
-                        inset -= 24;
-                        if (inset > 0) {
-                            tft.setCursor(inset, VertPos + 21);
-                            tft.print(">");     
-                        } 
-                    } 
-                    else {
-                        drawTextCentered(line, VertPos + 21, ST77XX_WHITE);
-                    }
-                    VertPos += SMALL_LINE_HEIGHT;
-                }
+            mGfx->fillRect(0, y, 240, job.mHeight, ST77XX_BLACK);
+            break;
+        }
+
+        case RenderJob::Op:
+            drawOp(mOps[job.mIndex], job.mFlags & RenderJob::EraseMarker);
+            break;
+
+        case RenderJob::BitmapRows: {
+            const TileBitmap* bitmap = mCurrentList->getLayout().mBitmap;
+            if (job.mIndex == 0) {
+                mBitmapDecoder = TileDecoder(*bitmap);
             }
+            drawRGBBitmap2XRows(0, job.mY + job.mIndex*2, bitmap, mBitmapDecoder, job.mHeight);
+            break;
         }
 
-        mCurrentLayout.mOptions = mDesiredLayout.mOptions;
-        mCurrentLayout.mSelection = mDesiredLayout.mSelection;
-        mPostOptionsVert = VertPos;
+        case RenderJob::ResetScroll:
+            resetScroll();
+            break;
+
+        case RenderJob::ScrollArea:
+            defineScrollArea(job.mY, job.mHeight);
+            break;
+
+        case RenderJob::FlushRow:
+            mFrameFlushBytes += mCanvas.flushTileRow(tft, job.mIndex);
+            break;
     }
-    else {
-        VertPos = mPostOptionsVert;
+}
+
+void DisplayManager::defineScrollArea(int top, int height) {
+    mScrollTop = 0;
+    mScrollHeight = 0;
+    mScrollOffset = 0;
+
+    // the canvas flush writes rows where they appear, so it can't scroll
+    if (isUsingCanvas() || height <= 0 || top + height > 320) {
+        return;
     }
+    mScrollTop = top;
+    mScrollHeight = height;
+
+    const int bottom = 320 - top - height;
+    uint8_t areas[6] = {
+        (uint8_t)(top >> 8), (uint8_t)top,
+        (uint8_t)(height >> 8), (uint8_t)height,
+        (uint8_t)(bottom >> 8), (uint8_t)bottom
+    };
+    tft.sendCommand(ST7789_VSCRDEF, areas, 6);
+    setScrollStart(top);
+}
 
-    mForceRepaint = false;
+void DisplayManager::setScrollStart(int row) {
+    uint8_t start[2] = { (uint8_t)(row >> 8), (uint8_t)row };
+    tft.sendCommand(ST7789_VSCRSADD, start, 2);
+}
+
+void DisplayManager::resetScroll() {
+    if (mScrollHeight > 0 && mScrollOffset != 0) {
+        setScrollStart(mScrollTop);
+    }
+    mScrollTop = 0;
+    mScrollHeight = 0;
+    mScrollOffset = 0;
+}
+
+int DisplayManager::toPanelRow(int y) const {
+    if (mScrollOffset == 0 || y < mScrollTop || y >= mScrollTop + mScrollHeight) {
+        return y;
+    }
+    return mScrollTop + (y - mScrollTop + mScrollOffset) % mScrollHeight;
+}
+
+bool DisplayManager::canScrollBy(int rows) const {
+    return mScrollHeight > 0 && abs(rows) * SMALL_LINE_HEIGHT < mScrollHeight;
+}
+
+void DisplayManager::scrollOptions(int rows, int oldSelection) {
+    mScrollOffset = (mScrollOffset + rows * SMALL_LINE_HEIGHT) % mScrollHeight;
+    if (mScrollOffset < 0) {
+        mScrollOffset += mScrollHeight;
+    }
+    setScrollStart(mScrollTop + mScrollOffset);
+
+    // the rows coming into view reuse the bands that just scrolled out
+    const int visibleRows = mScrollHeight / SMALL_LINE_HEIGHT;
+    const int firstNew = rows > 0 ? mStartLine + visibleRows - rows : mStartLine;
+    const int lastNew = firstNew + abs(rows) - 1;
+
+    DrawOp op;
+    for (int i = firstNew; i <= lastNew; ++i) {
+        if (mCurrentList->placeOption(i, mSelection, mStartLine, op)) {
+            mGfx->fillRect(0, toPanelRow(op.mTop), 240, op.mBottom - op.mTop, ST77XX_BLACK);
+            drawOp(op);
+        }
+    }
+
+    // rows that stayed in view only need their selection state fixed up
+    if (oldSelection < firstNew || oldSelection > lastNew) {
+        if (mCurrentList->placeOption(oldSelection, mSelection, mStartLine, op)) {
+            drawOp(op, true);
+        }
+    }
+    if (mSelection < firstNew || mSelection > lastNew) {
+        if (mCurrentList->placeOption(mSelection, mSelection, mStartLine, op)) {
+            drawOp(op);
+        }
+    }
+}
+
+void DisplayManager::drawOp(const DrawOp& op, bool eraseMarker) {
+    const String& text = mCurrentList->getText(op);
+    switch (op.mType) {
+        case DrawOp::Title:
+            setFont(&SerifGothicStd_Bold20pt7b);
+            drawText(op.mX, op.mY, text, op.mColor, op.mTop, op.mBottom);
+            break;
+
+        case DrawOp::Bitmap:
+            drawRGBBitmap2X(op.mX, op.mY, mCurrentList->getLayout().mBitmap);
+            break;
+
+        case DrawOp::Text:
+            setFont(&SerifGothicStd_Bold12pt7b);
+            drawText(op.mX, op.mY, text, op.mColor, op.mTop, op.mBottom);
+            break;
+
+        case DrawOp::Option: {
+            // options may be scrolled, so draw where the band is shown
+            const int16_t top = toPanelRow(op.mTop);
+            const int16_t bottom = top + op.mBottom - op.mTop;
+            const int16_t y = top - op.mTop + op.mY;
+            setFont(&SerifGothicStd_Bold12pt7b);
+            drawText(op.mX, y, text, op.mColor, top, bottom);
+
+            const int16_t inset = op.mX - 24;
+            if (inset > 0 && text.length() > 0) {
+                if (op.mFlags & DrawOp::Selected) {
+                    drawText(inset, y, ">", ST77XX_YELLOW, top, bottom);
+                }
+                else if (eraseMarker) {
+                    drawText(inset, y, ">", ST77XX_BLACK, top, bottom);
+                }
+            }
+            break;
+        }
+    }
+}
+
+void DisplayManager::dumpDisplayList(Print& out) const {
+    if (mCurrentList == nullptr) {
+        out.println(F("display list: nothing shown"));
+        return;
+    }
+    mCurrentList->dump(out, mOps);
+    out.print(F("start line "));
+    out.print(mStartLine);
+    out.print(F(", selection "));
+    out.println(mSelection);
 }
 
 void DisplayManager::setDesiredLayout(const ScreenLayout& layout) {
     mDesiredLayout = layout;
 }
 
-void DisplayManager::repaint() {
-    update();
-}
\ No newline at end of file
+void DisplayManager::prepare(const ScreenLayout& layout) {
+    findList(layout);
+}
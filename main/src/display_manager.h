@@ -7,6 +7,9 @@
 #include <array>
 #include <vector>
 #include "screen_layout.h"
+#include "display_list.h"
+#include "frame_canvas.h"
+#include "glyph_strip.h"
 
 #if defined(ARDUINO_FEATHER_ESP32) // Feather Huzzah32
   #define TFT_CS         14
@@ -26,14 +29,31 @@
   #define TFT_DC         5//3//8
 #endif
 
+// Compose each frame into an off-screen canvas and only push the tiles
+// that changed. Needs ~300KB, so it is only on by default with PSRAM.
+#ifndef DISPLAY_USE_CANVAS
+  #if defined(BOARD_HAS_PSRAM)
+    #define DISPLAY_USE_CANVAS 1
+  #else
+    #define DISPLAY_USE_CANVAS 0
+  #endif
+#endif
+
+// How long DisplayManager::update() may spend painting per call. A large
+// repaint is spread over several calls so input and sound keep running.
+#ifndef DISPLAY_RENDER_BUDGET_US
+  #define DISPLAY_RENDER_BUDGET_US 4000
+#endif
+
 class DisplayManager {
 
 public:
     void setup();
     
-    void drawRGBBitmap(int16_t x, int16_t y, const uint16_t *pcolors);
-    void drawRGBBitmap2X( int16_t x, int16_t y, const uint16_t *pcolors);
+    void drawRGBBitmap(int16_t x, int16_t y, const TileBitmap *tile);
+    void drawRGBBitmap2X( int16_t x, int16_t y, const TileBitmap *tile);
 
+    // paints everything that is pending, ignoring the render budget
     void repaint();
 
     const ScreenLayout& getState() const {
@@ -49,8 +69,8 @@ public:
     void setTitle(const String& title);
     String getTitle() const;
 
-    void setBitmapsAndValues(const uint16_t* primaryBitmap, const uint16_t* secondaryBitmap);
-    void setBitmapAndValue(const uint16_t* primaryBitmap, int value);
+    void setBitmapsAndValues(const TileBitmap* primaryBitmap, const TileBitmap* secondaryBitmap);
+    void setBitmapAndValue(const TileBitmap* primaryBitmap, int value);
     void clearBitmaps();
 
     void setValues(int left, int right, uint16_t leftColor, uint16_t rightColor);
@@ -71,21 +91,121 @@ public:
 
     int16_t drawTextCentered(const String& text, int yPos, uint16_t color);
 
+    // width in pixels of text in the current font, without drawing it
+    int16_t measureText(const String& text);
+    static int16_t measureText(const String& text, const GFXfont* font);
+
     void setDesiredLayout(const ScreenLayout& layout);
+    // compiles a layout without showing it, so when a screen is known ahead
+    // of time, showing it later only has to draw, whatever its selection
+    void prepare(const ScreenLayout& layout);
     void update();
+
+    bool isRendering() const {
+        return mNextJob < mJobs.size();
+    }
+    // true until the desired layout is all on screen
+    bool hasWork() const;
+    void setRenderBudget(uint32_t budgetUs) {
+        mRenderBudget = budgetUs;
+    }
+    uint32_t getRenderOverruns() const {
+        return mTotalOverruns;
+    }
+
+    bool isUsingCanvas() const {
+        return mGfx == &mCanvas;
+    }
+    uint32_t getLastFlushBytes() const {
+        return mFrameFlushBytes;
+    }
+
+    // prints the draw ops of the screen being shown
+    void dumpDisplayList(Print& out) const;
    
 private:
+    // one resumable step of a repaint
+    struct RenderJob {
+        enum Type : uint8_t {
+            Clear,       // fill mHeight rows from mY with black
+            Op,          // draw placed op mIndex of the current display list
+            BitmapRows,  // mHeight tile rows starting at row mIndex
+            ResetScroll,
+            ScrollArea,
+            FlushRow,    // push canvas tile row mIndex
+        };
+        enum Flags : uint8_t {
+            EraseMarker = 1,
+        };
+        Type mType;
+        uint8_t mFlags;
+        int16_t mY;
+        int16_t mHeight;
+        int16_t mIndex;
+    };
+
+    struct TextWidth {
+        const GFXfont* mFont = nullptr;
+        String mText;
+        int16_t mWidth = 0;
+    };
+
+    void planFrame();
+    const DisplayList* findList(const ScreenLayout& layout);
+    void planRepaint();
+    void planDelta(const DisplayList& shown);
+    void addDrawJob(int opIndex, uint8_t flags = 0);
+    void addJob(RenderJob::Type type, int16_t y = 0, int16_t height = 0, int16_t index = 0, uint8_t flags = 0);
+    void runJobs(uint32_t budgetUs);
+    void runJob(const RenderJob& job);
+    void drawRGBBitmap2XRows(int16_t x, int16_t y, const TileBitmap *tile, TileDecoder& decoder, int16_t rows);
+
+    void setFont(const GFXfont* font);
+    // text owns rows [top, bottom), nothing outside them is drawn over
+    void drawText(int16_t x, int16_t y, const String& text, uint16_t color, int16_t top, int16_t bottom);
+    void drawOp(const DrawOp& op, bool eraseMarker = false);
+
+    // hardware vertical scrolling of the option rows
+    void defineScrollArea(int top, int height);
+    void setScrollStart(int row);
+    void resetScroll();
+    int toPanelRow(int y) const;
+    bool canScrollBy(int rows) const;
+    void scrollOptions(int rows, int oldSelection);
+
     Adafruit_ST7789 tft = Adafruit_ST7789(TFT_CS, TFT_DC, TFT_RST);
-    ScreenLayout mCurrentLayout;
+    FrameCanvas mCanvas;
+    GlyphStrip mGlyphStrip;
+    Adafruit_GFX* mGfx = &tft;
+    const GFXfont* mFont = nullptr;
+    std::array<TextWidth, 24> mWidthCache;
+    int mNextWidthSlot = 0;
     ScreenLayout mDesiredLayout;
     bool mForceRepaint= true;
-    int mStartLine= 0;
 
-    int mPostTitleVert = 0;
-    int mPostBitmapVert = 0;
-    int mPostNumbersVert = 0;
-    int mPostTextVert = 0;
-    int mPostOptionsVert = 0;
+    // recently shown screens stay compiled, so going back to one is cheap
+    std::array<DisplayList, 4> mLists;
+    int mNextList = 0;
+    const DisplayList* mCurrentList = nullptr;
+    // the current list's ops as placed for the selection, and the ops they
+    // replaced while a delta to them is planned
+    std::vector<DrawOp> mOps;
+    std::vector<DrawOp> mShownOps;
+    int mStartLine = 0;
+    int mSelection = 0;
+
+    int mScrollTop = 0;
+    int mScrollHeight = 0;
+    int mScrollOffset = 0;
+
+    std::vector<RenderJob> mJobs;
+    size_t mNextJob = 0;
+    TileDecoder mBitmapDecoder;
+    uint32_t mRenderBudget = DISPLAY_RENDER_BUDGET_US;
+    uint32_t mFrameFlushBytes = 0;
+    uint32_t mFrameOverruns = 0;
+    uint32_t mFrameWorstOverrun = 0;
+    uint32_t mTotalOverruns = 0;
 };
 
 #endif // DISPLAY_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "event_loop.h"
+
+#define WAKE_ALL (EventLoop::WAKE_INPUT | EventLoop::WAKE_SOUND)
+
+void EventLoop::setup() {
+    mEvents = xEventGroupCreateStatic(&mEventsBuffer);
+}
+
+void EventLoop::wake(uint32_t events) {
+    xEventGroupSetBits(mEvents, events);
+}
+
+void IRAM_ATTR EventLoop::wakeFromISR(uint32_t events) {
+    BaseType_t woken = pdFALSE;
+    xEventGroupSetBitsFromISR(mEvents, events, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void EventLoop::wakeAt(uint32_t ms) {
+    // the earliest time wins, compared so millis() can wrap
+    if (!mHasDeadline || (int32_t)(ms - mDeadline) < 0) {
+        mDeadline = ms;
+        mHasDeadline = true;
+    }
+}
+
+uint32_t EventLoop::wait() {
+    int32_t sleep = EVENT_LOOP_IDLE_MS;
+    if (mHasDeadline) {
+        sleep = std::min<int32_t>(sleep, std::max<int32_t>((int32_t)(mDeadline - millis()), 0));
+    }
+    mHasDeadline = false;
+
+    // rounded up, waking a tick early would only mean an idle pass
+    const TickType_t ticks = sleep > 0 ? pdMS_TO_TICKS(sleep + portTICK_PERIOD_MS - 1) : 0;
+    const uint32_t events = xEventGroupWaitBits(mEvents, WAKE_ALL, pdTRUE, pdFALSE, ticks) & WAKE_ALL;
+    ++mPasses;
+    if (events) {
+        ++mEventPasses;
+    }
+    return events;
+}
+
+void IRAM_ATTR EventLoop::input_isr(void* arg) {
+    ((EventLoop*)arg)->wakeFromISR(WAKE_INPUT);
+}
+
+void EventLoop::sound_callback(void* arg) {
+    ((EventLoop*)arg)->wake(WAKE_SOUND);
+}
@@ -0,0 +1,66 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <Arduino.h>
+#include "FreeRTOS.h"
+#include "event_groups.h"
+
+// the longest the loop sleeps with nothing to do, so serial commands are
+// still read
+#ifndef EVENT_LOOP_IDLE_MS
+  #define EVENT_LOOP_IDLE_MS 250
+#endif
+
+// Puts the main loop to sleep between passes instead of polling. Button
+// edges and the audio side set bits in a FreeRTOS event group, and each
+// pass asks for the next time it has something due; wait() blocks until
+// whichever comes first.
+class EventLoop {
+
+public:
+    enum : uint32_t {
+        WAKE_INPUT = 1,       // a button pin changed
+        WAKE_SOUND = 1 << 1,  // a sound stopped, or playback started or ended
+    };
+
+    void setup();
+
+    // from another task, or from an interrupt
+    void wake(uint32_t events);
+    void IRAM_ATTR wakeFromISR(uint32_t events);
+
+    // the next pass has to run by then (millis), or right away
+    void wakeAt(uint32_t ms);
+    void wakeIn(uint32_t ms) {
+        wakeAt(millis() + ms);
+    }
+    void wakeNow() {
+        wakeIn(0);
+    }
+
+    // sleeps until an event or the earliest time asked for since the last
+    // wait, returns the events that woke it
+    uint32_t wait();
+
+    // passes run, and how many of them an event started
+    uint32_t getPassCount() const {
+        return mPasses;
+    }
+    uint32_t getEventCount() const {
+        return mEventPasses;
+    }
+
+    // for InputManager::setWake() and SoundManager::setWake(), arg is the loop
+    static void IRAM_ATTR input_isr(void* arg);
+    static void sound_callback(void* arg);
+
+private:
+    EventGroupHandle_t mEvents = nullptr;
+    StaticEventGroup_t mEventsBuffer;
+    uint32_t mDeadline = 0;
+    bool mHasDeadline = false;
+    uint32_t mPasses = 0;
+    uint32_t mEventPasses = 0;
+};
+
+#endif // EVENT_LOOP_H
@@ -0,0 +1,170 @@
+#include <Arduino.h>
+#include "frame_canvas.h"
+
+static uint16_t* allocFrame() {
+    const size_t bytes = CANVAS_WIDTH * CANVAS_HEIGHT * sizeof(uint16_t);
+#if defined(BOARD_HAS_PSRAM)
+    if (psramFound()) {
+        return (uint16_t*)ps_malloc(bytes);
+    }
+#endif
+    return (uint16_t*)malloc(bytes);
+}
+
+FrameCanvas::~FrameCanvas() {
+    free(mFrame);
+    free(mFlushed);
+}
+
+bool FrameCanvas::begin() {
+    if (mFrame) {
+        return true;
+    }
+    mFrame = allocFrame();
+    mFlushed = allocFrame();
+    if (!mFrame || !mFlushed) {
+        free(mFrame);
+        free(mFlushed);
+        mFrame = nullptr;
+        mFlushed = nullptr;
+        return false;
+    }
+
+    // the panel starts out black, so both copies do too
+    memset(mFrame, 0, CANVAS_WIDTH * CANVAS_HEIGHT * sizeof(uint16_t));
+    memset(mFlushed, 0, CANVAS_WIDTH * CANVAS_HEIGHT * sizeof(uint16_t));
+    mDirty.fill(0);
+    return true;
+}
+
+void FrameCanvas::markDirty(int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    const int tx0 = x >> CANVAS_TILE_SHIFT;
+    const int tx1 = (x + w - 1) >> CANVAS_TILE_SHIFT;
+    const int ty0 = y >> CANVAS_TILE_SHIFT;
+    const int ty1 = (y + h - 1) >> CANVAS_TILE_SHIFT;
+    const uint16_t mask = (uint16_t)(((1 << (tx1 + 1)) - 1) & ~((1 << tx0) - 1));
+    for (int ty = ty0; ty <= ty1; ++ty) {
+        mDirty[ty] |= mask;
+    }
+}
+
+void FrameCanvas::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    if (!mFrame || x < 0 || y < 0 || x >= CANVAS_WIDTH || y >= CANVAS_HEIGHT) {
+        return;
+    }
+    mFrame[(int32_t)y * CANVAS_WIDTH + x] = __builtin_bswap16(color);
+    mDirty[y >> CANVAS_TILE_SHIFT] |= 1 << (x >> CANVAS_TILE_SHIFT);
+}
+
+void FrameCanvas::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (!mFrame) {
+        return;
+    }
+    // callers are loose with extents, so clip to the frame
+    int16_t x2 = std::min<int32_t>(x + w, CANVAS_WIDTH);
+    int16_t y2 = std::min<int32_t>(y + h, CANVAS_HEIGHT);
+    x = std::max<int16_t>(x, 0);
+    y = std::max<int16_t>(y, 0);
+    if (x >= x2 || y >= y2) {
+        return;
+    }
+    w = x2 - x;
+    h = y2 - y;
+    const uint16_t panelColor = __builtin_bswap16(color);
+    for (int16_t row = y; row < y2; ++row) {
+        uint16_t* dst = getRow(row) + x;
+        for (int16_t i = 0; i < w; ++i) {
+            dst[i] = panelColor;
+        }
+    }
+    markDirty(x, y, w, h);
+}
+
+void FrameCanvas::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    fillRect(x, y, w, 1, color);
+}
+
+void FrameCanvas::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    fillRect(x, y, 1, h, color);
+}
+
+void FrameCanvas::fillScreen(uint16_t color) {
+    fillRect(0, 0, CANVAS_WIDTH, CANVAS_HEIGHT, color);
+}
+
+bool FrameCanvas::tileChanged(int tx, int ty) const {
+    const int32_t offset = (int32_t)(ty << CANVAS_TILE_SHIFT) * CANVAS_WIDTH + (tx << CANVAS_TILE_SHIFT);
+    for (int row = 0; row < CANVAS_TILE_SIZE; ++row) {
+        const int32_t rowOffset = offset + row * CANVAS_WIDTH;
+        if (memcmp(mFrame + rowOffset, mFlushed + rowOffset, CANVAS_TILE_SIZE * sizeof(uint16_t)) != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void FrameCanvas::commitTile(int tx, int ty) {
+    const int32_t offset = (int32_t)(ty << CANVAS_TILE_SHIFT) * CANVAS_WIDTH + (tx << CANVAS_TILE_SHIFT);
+    for (int row = 0; row < CANVAS_TILE_SIZE; ++row) {
+        const int32_t rowOffset = offset + row * CANVAS_WIDTH;
+        memcpy(mFlushed + rowOffset, mFrame + rowOffset, CANVAS_TILE_SIZE * sizeof(uint16_t));
+    }
+}
+
+uint32_t FrameCanvas::flush(Adafruit_SPITFT& tft) {
+    mLastFlushBytes = 0;
+    for (int ty = 0; ty < CANVAS_TILES_Y; ++ty) {
+        mLastFlushBytes += flushTileRow(tft, ty);
+    }
+    return mLastFlushBytes;
+}
+
+uint32_t FrameCanvas::flushTileRow(Adafruit_SPITFT& tft, int ty) {
+    if (!mFrame || mDirty[ty] == 0) {
+        return 0;
+    }
+
+    // drop tiles that were drawn over with the same pixels
+    uint16_t changed = 0;
+    for (int tx = 0; tx < CANVAS_TILES_X; ++tx) {
+        if ((mDirty[ty] & (1 << tx)) && tileChanged(tx, ty)) {
+            changed |= 1 << tx;
+            commitTile(tx, ty);
+        }
+    }
+    mDirty[ty] = 0;
+    if (changed == 0) {
+        return 0;
+    }
+
+    // push each horizontal run of changed tiles as one window
+    uint32_t bytes = 0;
+    tft.startWrite();
+    int tx = 0;
+    while (tx < CANVAS_TILES_X) {
+        if ((changed & (1 << tx)) == 0) {
+            ++tx;
+            continue;
+        }
+        const int runStart = tx;
+        while (tx < CANVAS_TILES_X && (changed & (1 << tx))) {
+            ++tx;
+        }
+
+        const int16_t x = runStart << CANVAS_TILE_SHIFT;
+        const int16_t y = ty << CANVAS_TILE_SHIFT;
+        const int16_t w = (tx - runStart) << CANVAS_TILE_SHIFT;
+        tft.setAddrWindow(x, y, w, CANVAS_TILE_SIZE);
+        for (int row = 0; row < CANVAS_TILE_SIZE; ++row) {
+            tft.writePixels(getRow(y + row) + x, w, true, true);
+        }
+        bytes += (uint32_t)w * CANVAS_TILE_SIZE * sizeof(uint16_t);
+    }
+    tft.endWrite();
+
+    mTotalFlushBytes += bytes;
+    return bytes;
+}
@@ -0,0 +1,67 @@
+#ifndef FRAME_CANVAS_H
+#define FRAME_CANVAS_H
+
+#include <Adafruit_GFX.h>
+#include <Adafruit_SPITFT.h>
+#include <array>
+
+#define CANVAS_WIDTH 240
+#define CANVAS_HEIGHT 320
+#define CANVAS_TILE_SHIFT 4
+#define CANVAS_TILE_SIZE (1 << CANVAS_TILE_SHIFT)
+#define CANVAS_TILES_X (CANVAS_WIDTH / CANVAS_TILE_SIZE)
+#define CANVAS_TILES_Y (CANVAS_HEIGHT / CANVAS_TILE_SIZE)
+
+// An off-screen RGB565 frame the size of the panel. Drawing marks the
+// 16x16 tiles it touches; flush() compares those tiles against the last
+// frame sent to the panel and only pushes the ones that really changed.
+// Pixels are kept in the panel's big-endian byte order so the flush can
+// send them as they are.
+class FrameCanvas : public Adafruit_GFX {
+
+public:
+    FrameCanvas() : Adafruit_GFX(CANVAS_WIDTH, CANVAS_HEIGHT) {}
+    ~FrameCanvas();
+
+    // allocates the frame and its shadow copy (from PSRAM when present)
+    bool begin();
+    bool isReady() const {
+        return mFrame != nullptr;
+    }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+    void fillScreen(uint16_t color) override;
+
+    // direct access for blitters; callers must write big-endian pixels and
+    // markDirty() what they write
+    uint16_t* getRow(int16_t y) {
+        return mFrame + (int32_t)y * CANVAS_WIDTH;
+    }
+    void markDirty(int16_t x, int16_t y, int16_t w, int16_t h);
+
+    // push changed tiles to the panel, returns the number of bytes sent
+    uint32_t flush(Adafruit_SPITFT& tft);
+    uint32_t flushTileRow(Adafruit_SPITFT& tft, int ty);
+
+    uint32_t getLastFlushBytes() const {
+        return mLastFlushBytes;
+    }
+    uint32_t getTotalFlushBytes() const {
+        return mTotalFlushBytes;
+    }
+
+private:
+    bool tileChanged(int tx, int ty) const;
+    void commitTile(int tx, int ty);
+
+    uint16_t* mFrame = nullptr;
+    uint16_t* mFlushed = nullptr;
+    std::array<uint16_t, CANVAS_TILES_Y> mDirty = {};
+    uint32_t mLastFlushBytes = 0;
+    uint32_t mTotalFlushBytes = 0;
+};
+
+#endif // FRAME_CANVAS_H
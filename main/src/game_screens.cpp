@@ -1,54 +1,38 @@
 #include <Arduino.h>
 #include "game_state.h"
 #include "game_screens.h"
-#include "assets/sounds.h"
-#include "assets/images.h"
-#include <deque>
+#include "asset_pack.h"
+#include "screen_task.h"
+#if ASSETS_IN_PARTITION
+  #include "assets/asset_names.h"
+#else
+  #include "assets/sounds.h"
+  #include "assets/images.h"
+#endif
+
+
+bool loadAssets() {
+#if ASSETS_IN_PARTITION
+    // the assets point into the mapping, which is never closed
+    static AssetPack pack;
+    if (!pack.open()) {
+        return false;
+    }
+    return pack.bind(sound_assets, sound_assets_LEN, tile_assets, tile_assets_LEN);
+#else
+    return true;
+#endif
+}
 
 
 void playBeep() {
-    if (!gGameState.soundManager.isPlaying()) {
-        gGameState.soundManager.play(beep_snd, false); 
-    } 
+    gGameState.soundManager.play(beep_snd, false, SoundPriority::Ui); 
 }
 
 void playErrorSound() {
-    if (!gGameState.soundManager.isPlaying()) {
-        gGameState.soundManager.play(beep_snd, false); 
-    } 
+    gGameState.soundManager.play(beep_snd, false, SoundPriority::Ui); 
 }
 
-struct ScreenList {
-    std::deque<ScreenLayout> mScreenList;
-    int32_t mStartTime;
-
-    int count() {
-        return mScreenList.size();
-    }
-
-    void addScreen(const ScreenLayout& screen) {
-       mScreenList.push_back(screen); 
-    }
-
-    bool nextScreen() {
-        mStartTime = millis();
-        if (mScreenList.size()) {
-            gGameState.displayManager.setDesiredLayout(mScreenList.front());
-            mScreenList.pop_front();
-            return true;
-        }
-        return false;
-    }
-
-    void clear() {
-      mScreenList.clear();  
-    }
-
-    int32_t timeInScreen() {
-        return millis() - mStartTime;
-    }
-};
-
 const String& getKingdomName(int i) {
     static String Arisilon("Arisilon");
     static String Brynthia("Brynthia");
@@ -104,21 +88,21 @@ const String&  getInventoryName(int i) {
     return UNKNOWN;
 }
 
-static const uint16_t* InventoryPictures[(int)Inventory::COUNT] = {
-    tile_bitmap_warriors,
-    tile_bitmap_gold,
-    tile_bitmap_food,
-    tile_bitmap_beast,
-    tile_bitmap_scout,
-    tile_bitmap_healer,
-    tile_bitmap_pegasus,
-    tile_bitmap_sword,
-    tile_bitmap_brasskey,
-    tile_bitmap_silverkey,
-    tile_bitmap_goldkey
+static const TileBitmap* InventoryPictures[(int)Inventory::COUNT] = {
+    &tile_bitmap_warriors,
+    &tile_bitmap_gold,
+    &tile_bitmap_food,
+    &tile_bitmap_beast,
+    &tile_bitmap_scout,
+    &tile_bitmap_healer,
+    &tile_bitmap_pegasus,
+    &tile_bitmap_sword,
+    &tile_bitmap_brasskey,
+    &tile_bitmap_silverkey,
+    &tile_bitmap_goldkey
 };
 
-const uint16_t* getInventoryPicture(int i) {
+const TileBitmap* getInventoryPicture(int i) {
     static String UNKNOWN("UNKNOWN");
     if (i>=0 && i<(int)Inventory::COUNT)  
     {
@@ -145,6 +129,168 @@ struct AutoConfirmScreen : public GameScreen {
     virtual void deny() override {};
 };
 
+//
+// Base for screens that run as a coroutine. begin() starts run(), and
+// update() and onSelection() resume it once what it awaits has happened.
+//
+struct TaskScreen : public GameScreen {
+    ScreenTask mTask;
+    bool mResuming = false;
+    bool mRestart = false;
+    bool mHasSelection = false;
+    bool mSoundFinished = false;
+    int mSelection = -1;
+    int mPages = 0;
+
+    virtual ScreenTask run() = 0;
+
+    virtual void begin() override {
+        // run() swapping in this screen again starts over once it suspends
+        if (mResuming) {
+            mRestart = true;
+            return;
+        }
+        mHasSelection = false;
+        mPages = 0;
+        // the old frame goes back to the pool before the new one is taken
+        mTask = ScreenTask();
+        mTask = run();
+        resume(-1);
+    }
+
+    virtual void update(int32_t /*elapsedMS*/) override {
+        while (isReady()) {
+            resume(-1);
+        }
+    }
+
+    virtual int32_t nextUpdateIn(int32_t /*elapsedMS*/) override {
+        switch (mTask.getWait()) {
+            case ScreenWait::Shown:
+                // a frame still drawing keeps the loop awake anyway
+                return gGameState.displayManager.hasWork() ? -1 : 0;
+            case ScreenWait::Time:
+                return std::max<int32_t>((int32_t)(mTask.getWakeAt() - millis()), 0);
+            case ScreenWait::Selection:
+                if (mTask.hasTimeout()) {
+                    return std::max<int32_t>((int32_t)(mTask.getWakeAt() - millis()), 0);
+                }
+                return -1;
+            default:
+                // a sound ending wakes the loop on its own
+                return -1;
+        }
+    }
+
+    virtual void onSelection() override {
+        const int value = gGameState.displayManager.getSelectedOption().mValue;
+        if (mTask.getWait() == ScreenWait::Selection) {
+            resume(value);
+        }
+        else {
+            // Select while a page is still drawing is for that page
+            mHasSelection = true;
+            mSelection = value;
+        }
+    }
+
+    // the awaitables run() co_awaits. A page is set with setDesiredLayout()
+    // in a statement of its own before the co_await, so the layout's
+    // temporaries don't live across the suspension and take up the frame.
+
+    // waits until the desired layout is all on screen
+    ScreenTask::Await shown() {
+        ScreenTask::Await wait;
+        wait.mWait = ScreenWait::Shown;
+        return wait;
+    }
+
+    // shows layout and waits until it is all on screen. The layout is best
+    // built by a function, as a braced one here would live in the frame.
+    ScreenTask::Await show(const ScreenLayout& layout) {
+        gGameState.displayManager.setDesiredLayout(layout);
+        return shown();
+    }
+
+    ScreenTask::Await delay(uint32_t ms) {
+        ScreenTask::Await wait;
+        wait.mWait = ScreenWait::Time;
+        wait.mWakeAt = millis() + ms;
+        return wait;
+    }
+
+    // the value of the option picked, or -1 once timeoutMs is up
+    ScreenTask::Await selection(int32_t timeoutMs = -1) {
+        ScreenTask::Await wait;
+        if (mHasSelection) {
+            mHasSelection = false;
+            wait.mResult = mSelection;
+            return wait;
+        }
+        wait.mWait = ScreenWait::Selection;
+        if (timeoutMs >= 0) {
+            wait.mHasTimeout = true;
+            wait.mWakeAt = millis() + timeoutMs;
+        }
+        return wait;
+    }
+
+    // waits until the sound is heard out, woken by it finishing
+    ScreenTask::Await sound(SoundHandle handle) {
+        ScreenTask::Await wait;
+        if (!gGameState.soundManager.isFinished(handle)) {
+            wait.mWait = ScreenWait::Sound;
+            wait.mSound = handle;
+            mSoundFinished = false;
+            gGameState.soundManager.onFinished(handle, &sound_finished, this);
+        }
+        return wait;
+    }
+
+    // the desired layout as one page of a sequence: turns the page, with a
+    // sound after the first, and waits for Select
+    ScreenTask::Await page(int32_t timeoutMs = -1) {
+        if (mPages++ > 0) {
+            gGameState.soundManager.play(rotate_snd, true);
+        }
+        return selection(timeoutMs);
+    }
+
+private:
+    bool isReady() const {
+        switch (mTask.getWait()) {
+            case ScreenWait::Shown:
+                return !gGameState.displayManager.hasWork();
+            case ScreenWait::Time:
+                return (int32_t)(millis() - mTask.getWakeAt()) >= 0;
+            case ScreenWait::Selection:
+                return mTask.hasTimeout() && (int32_t)(millis() - mTask.getWakeAt()) >= 0;
+            case ScreenWait::Sound:
+                // a screen started over can still get an older sound's call
+                return mSoundFinished && gGameState.soundManager.isFinished(mTask.getSound());
+            default:
+                return false;
+        }
+    }
+
+    static void sound_finished(void* context) {
+        ((TaskScreen*)context)->mSoundFinished = true;
+    }
+
+    void resume(int result) {
+        mResuming = true;
+        mTask.resume(result);
+        mResuming = false;
+        if (mTask.isDone()) {
+            mTask = ScreenTask();
+        }
+        if (mRestart) {
+            mRestart = false;
+            begin();
+        }
+    }
+};
+
 //
 // ************
 // GAME SCREENS
@@ -164,7 +310,7 @@ struct GameOver : public GameScreen {
  
         gGameState.displayManager.setDesiredLayout({
             "GAME OVER", // title
-            nullptr, //const uint16_t* bitmap ; 
+            nullptr, //const TileBitmap* bitmap ; 
             {
                 {"You are out", ST77XX_RED},
                 {"of Warriors", ST77XX_RED}
@@ -198,7 +344,7 @@ struct Victory : public GameScreen {
  
         gGameState.displayManager.setDesiredLayout({
             Title, // title
-            tile_bitmap_victory, //const uint16_t* bitmap ; 
+            &tile_bitmap_victory, //const TileBitmap* bitmap ; 
             {
                 {"WINNER!", ST77XX_GREEN}
             }, //std::vector<TextLine> textLines;
@@ -228,10 +374,9 @@ bool checkForEndGame() {
     return false;
 }
 
-struct PlayerCursed : public GameScreen {
-    ScreenList mScreenList;
+struct PlayerCursed : public TaskScreen {
 
-    virtual void begin() override {
+    virtual ScreenTask run() override {
         const int playerIdx= gGameState.worldState.mCurrentPlayer;
         auto& player = gGameState.worldState.mPlayers[playerIdx];
 
@@ -249,9 +394,9 @@ struct PlayerCursed : public GameScreen {
         String Title = "PLAYER ";
         Title += String(playerIdx+1);
 
-        mScreenList.addScreen({
+        gGameState.displayManager.setDesiredLayout({
             Title, // title
-            tile_bitmap_cursed, //const uint16_t* bitmap ; 
+            &tile_bitmap_cursed, //const TileBitmap* bitmap ; 
             {
                 {"A Wizards Curse", ST77XX_RED}, 
                 {"takes effect!", ST77XX_RED}
@@ -261,10 +406,11 @@ struct PlayerCursed : public GameScreen {
             },//std::vector<TextLine> options;
             0 //int selection = 0)      
         });
+        co_await page();
 
-        mScreenList.addScreen({
+        gGameState.displayManager.setDesiredLayout({
             "CURSED!", // title
-            tile_bitmap_warriors, //const uint16_t* bitmap ; 
+            &tile_bitmap_warriors, //const TileBitmap* bitmap ; 
             {
                 {"You Lost", ST77XX_WHITE}, 
                 {cursedWarriors, ST77XX_RED}
@@ -274,9 +420,10 @@ struct PlayerCursed : public GameScreen {
             },//std::vector<TextLine> options;
             0 //int selection = 0)      
         });
-        mScreenList.addScreen({
+        co_await page();
+        gGameState.displayManager.setDesiredLayout({
             "CURSED!", // title
-            tile_bitmap_gold, //const uint16_t* bitmap ; 
+            &tile_bitmap_gold, //const TileBitmap* bitmap ; 
             {
                 {"You Lost", ST77XX_WHITE}, 
                 {cursedGold, ST77XX_RED}
@@ -286,32 +433,20 @@ struct PlayerCursed : public GameScreen {
             },//std::vector<TextLine> options;
             0 //int selection = 0)      
         });
- 
-        // display the screen list
-        mScreenList.nextScreen();
-    }
+        co_await page();
 
-    virtual void onSelection() override {
-        if (mScreenList.count() > 0) {
-            gGameState.soundManager.play(rotate_snd, true);
-            mScreenList.nextScreen(); 
-        }
-        else {
-            gGameState.popScreen();    
-        }
+        gGameState.popScreen();
     }
 
 } gPlayerCursed;
 
-struct CitadelScreen : public GameScreen {
-    ScreenList mScreenList;
+struct CitadelScreen : public TaskScreen {
 
-    virtual void begin() override {
+    virtual ScreenTask run() override {
         const int playerIdx= gGameState.worldState.mCurrentPlayer;
         Player& player = gGameState.worldState.mPlayers[playerIdx];
        
         gGameState.soundManager.play(sanctuary_snd, true);
-        mScreenList.clear();
 
         const int lastBuilding = player.mLastBuilding;
         player.mLastBuilding = (int)Location::Citadel;
@@ -329,9 +464,9 @@ struct CitadelScreen : public GameScreen {
             const int giftCount = player.adjustWarriors(player.mInventory[(int)Inventory::Warriors]);
             const String giftString = String(giftCount) + String(" Warriors!");    
 
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 "CITADEL", // title
-                tile_bitmap_warriors, //const uint16_t* bitmap ; 
+                &tile_bitmap_warriors, //const TileBitmap* bitmap ; 
                 {
                     {"You Gained", ST77XX_WHITE}, 
                     {giftString, ST77XX_GREEN}
@@ -341,15 +476,16 @@ struct CitadelScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            co_await page();
         } 
         else if (player.mInventory[(int)Inventory::Warriors] <= 4)
         {
             const int giftCount = player.adjustWarriors(random(4)+5);
             const String giftString = String(giftCount) + String(" Warriors!");    
             
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 "CITADEL", // title
-                tile_bitmap_warriors, //const uint16_t* bitmap ; 
+                &tile_bitmap_warriors, //const TileBitmap* bitmap ; 
                 {
                     {"You Gained", ST77XX_WHITE}, 
                     {giftString, ST77XX_GREEN}
@@ -359,6 +495,7 @@ struct CitadelScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            co_await page();
         }
             
         if (player.mInventory[(int)Inventory::Food] <= 5)
@@ -366,9 +503,9 @@ struct CitadelScreen : public GameScreen {
             const int giftCount = player.adjustFood(random(6)+10);
             const String giftString = String(giftCount) + String(" Food!"); 
 
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 "CITADEL", // title
-                tile_bitmap_food, //const uint16_t* bitmap ; 
+                &tile_bitmap_food, //const TileBitmap* bitmap ; 
                 {
                     {"You Gained", ST77XX_WHITE}, 
                     {giftString, ST77XX_GREEN}
@@ -378,6 +515,7 @@ struct CitadelScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            co_await page();
         }
         
         if (player.mInventory[(int)Inventory::Gold] <= 7)
@@ -385,9 +523,9 @@ struct CitadelScreen : public GameScreen {
             const int giftCount = player.adjustGold(random(6)+10);
             const String giftString = String(giftCount) + String(" Gold!");
 
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 "CITADEL", // title
-                tile_bitmap_gold, //const uint16_t* bitmap ; 
+                &tile_bitmap_gold, //const TileBitmap* bitmap ; 
                 {
                     {"You Gained", ST77XX_WHITE}, 
                     {giftString, ST77XX_GREEN}
@@ -397,12 +535,13 @@ struct CitadelScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            co_await page();
         }
 
-        if (mScreenList.count() == 0) {
-            mScreenList.addScreen({
+        if (mPages == 0) {
+            gGameState.displayManager.setDesiredLayout({
                 "CITADEL", // title
-                nullptr, //const uint16_t* bitmap ; 
+                nullptr, //const TileBitmap* bitmap ; 
                 {
                     {"No help is", ST77XX_WHITE}, 
                     {"needed now", ST77XX_WHITE}
@@ -412,46 +551,31 @@ struct CitadelScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            co_await page();
         }
-        
-        // display the screen list
-        mScreenList.nextScreen();
-    }
-
-    virtual void onSelection() override {
-        const int playerIdx= gGameState.worldState.mCurrentPlayer;
-        auto& player = gGameState.worldState.mPlayers[playerIdx];
 
-        if (mScreenList.count() > 0) {
-            gGameState.soundManager.play(rotate_snd, true);
-            mScreenList.nextScreen(); 
-        }
-        else {
-            gGameState.popScreen();    
-        }
+        gGameState.popScreen();
     }
 
 } gCitadelScreen;
 
 
-struct PlayerInventory : public GameScreen {
-    ScreenList mScreenList;
+struct PlayerInventory : public TaskScreen {
 
-    virtual void begin() override {
+    virtual ScreenTask run() override {
         const int playerIdx= gGameState.worldState.mCurrentPlayer;
         Player& player = gGameState.worldState.mPlayers[playerIdx];
        
         gGameState.soundManager.play(rotate_snd, true);
-        mScreenList.clear();
         player.mTurnCompleted = true;
 
         for (int slot=0; slot < player.mInventory.size(); ++slot)
         {
             if (player.mInventory[slot] > 0) 
             {
-                mScreenList.addScreen({
+                gGameState.displayManager.setDesiredLayout({
                     "INVENTORY", // title
-                    getInventoryPicture(slot), //const uint16_t* bitmap ; 
+                    getInventoryPicture(slot), //const TileBitmap* bitmap ; 
                     {
                         {String(player.mInventory[slot]), ST77XX_GREEN}
                     }, //std::vector<TextLine> textLines;
@@ -460,13 +584,14 @@ struct PlayerInventory : public GameScreen {
                     },//std::vector<TextLine> options;
                     0 //int selection = 0)      
                 });
+                co_await page();
             }
         }
 
-        if (!mScreenList.nextScreen()) {
+        if (mPages == 0) {
             gGameState.displayManager.setDesiredLayout({
                 "INVENTORY", // title
-                nullptr, //const uint16_t* bitmap ; 
+                nullptr, //const TileBitmap* bitmap ; 
                 {
                     {"Error!", ST77XX_WHITE}, 
                     {"Try later?", ST77XX_WHITE}
@@ -476,36 +601,25 @@ struct PlayerInventory : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
-            
-            return;
+            co_await page();
         }
-    }
 
-    virtual void onSelection() override {
-        if (mScreenList.count() > 0) {
-            gGameState.soundManager.play(rotate_snd, true);
-            mScreenList.nextScreen(); 
-        }
-        else {
-            gGameState.popScreen();    
-        }
+        gGameState.popScreen();
     }
 
 } gPlayerInventory;
 
-struct DragonScreen : public GameScreen {
-    ScreenList mScreenList;
+struct DragonScreen : public TaskScreen {
 
-    virtual void begin() override 
+    virtual ScreenTask run() override 
     {
         const int playerIdx= gGameState.worldState.mCurrentPlayer;
         Player& player = gGameState.worldState.mPlayers[playerIdx];
        
-        mScreenList.clear();
 
-       	mScreenList.addScreen({
+       	gGameState.displayManager.setDesiredLayout({
             "ATTACKED!", // title
-            tile_bitmap_dragon, //const uint16_t* bitmap ; 
+            &tile_bitmap_dragon, //const TileBitmap* bitmap ; 
             {
                 {"The Dragon attacks!", ST77XX_WHITE}
             }, //std::vector<TextLine> textLines;
@@ -514,6 +628,7 @@ struct DragonScreen : public GameScreen {
             },//std::vector<TextLine> options;
             0 //int selection = 0)      
         });
+       	co_await page();
 
         if (player.mInventory[(int)Inventory::Sword] <= 0) 
         {
@@ -530,9 +645,9 @@ struct DragonScreen : public GameScreen {
             }
             String cursedGold = String(lostGold) + String(" Gold");
 
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 "ATTACKED!", // title
-                tile_bitmap_warriors, //const uint16_t* bitmap ; 
+                &tile_bitmap_warriors, //const TileBitmap* bitmap ; 
                 {
                     {"The Dragon takes", ST77XX_WHITE},
                     {cursedWarriors, ST77XX_RED}
@@ -542,10 +657,11 @@ struct DragonScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            co_await page();
 
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 "ATTACKED!", // title
-                tile_bitmap_gold, //const uint16_t* bitmap ; 
+                &tile_bitmap_gold, //const TileBitmap* bitmap ; 
                 {
                     {"The Dragon takes", ST77XX_WHITE},
                     {cursedGold, ST77XX_RED}
@@ -555,6 +671,7 @@ struct DragonScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            co_await page();
         }
         else 
         {
@@ -572,9 +689,9 @@ struct DragonScreen : public GameScreen {
             }
             String gainedGold = String(newGold) + String(" Gold");
 
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 "DRAGON", // title
-                tile_bitmap_sword, //const uint16_t* bitmap ; 
+                &tile_bitmap_sword, //const TileBitmap* bitmap ; 
                 {
                     {"You defeated", ST77XX_WHITE},
                     {"the Dragon!", ST77XX_WHITE}
@@ -584,10 +701,11 @@ struct DragonScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            co_await page();
             
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 "DRAGON", // title
-                tile_bitmap_warriors, //const uint16_t* bitmap ; 
+                &tile_bitmap_warriors, //const TileBitmap* bitmap ; 
                 {
                     {"You Gained", ST77XX_WHITE}, 
                     {gainedWarriors, ST77XX_GREEN}
@@ -597,10 +715,11 @@ struct DragonScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            co_await page();
 
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 "DRAGON", // title
-                tile_bitmap_gold, //const uint16_t* bitmap ; 
+                &tile_bitmap_gold, //const TileBitmap* bitmap ; 
                 {
                     {"You Gained", ST77XX_WHITE}, 
                     {gainedGold, ST77XX_GREEN}
@@ -610,11 +729,12 @@ struct DragonScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            co_await page();
         }
 
-        mScreenList.addScreen({
+        gGameState.displayManager.setDesiredLayout({
             "DRAGON", // title
-            nullptr, //const uint16_t* bitmap ; 
+            nullptr, //const TileBitmap* bitmap ; 
             {
                 {"Move Dragon", ST77XX_WHITE}, 
                 {"to any open", ST77XX_WHITE},
@@ -625,21 +745,9 @@ struct DragonScreen : public GameScreen {
             },//std::vector<TextLine> options;
             0 //int selection = 0)      
         });
-    
-        // display the screen list
-        mScreenList.nextScreen();
-    }
+        co_await page();
 
-    virtual void onSelection() override {
-        if (mScreenList.count() > 0) 
-        {
-            gGameState.soundManager.play(rotate_snd, true);
-            mScreenList.nextScreen(); 
-        }
-        else 
-        {
-            gGameState.popScreen();    
-        }
+        gGameState.popScreen();
     }
 
 } gDragonScreen;
@@ -656,7 +764,7 @@ struct MoveBack : public GameScreen {
  
         gGameState.displayManager.setDesiredLayout({
             "GO BACK", // title
-            nullptr, //const uint16_t* bitmap ; 
+            nullptr, //const TileBitmap* bitmap ; 
             {
                 {"You must return", ST77XX_WHITE},
                 {"to your previous", ST77XX_WHITE},
@@ -695,7 +803,7 @@ struct Frontier : public GameScreen {
 			gGameState.soundManager.play(player_hit_snd, true);
 			gGameState.displayManager.setDesiredLayout({
 				"NO EXIT", // title
-				tile_bitmap_keymissing, //const uint16_t* bitmap ; 
+				&tile_bitmap_keymissing, //const TileBitmap* bitmap ; 
 				{
 					{"You must find", ST77XX_WHITE},
 					{"a key first", ST77XX_WHITE}
@@ -713,7 +821,7 @@ struct Frontier : public GameScreen {
 			gGameState.soundManager.play(player_hit_snd, true);
  			gGameState.displayManager.setDesiredLayout({
 				"NO EXIT", // title
-				nullptr, //const uint16_t* bitmap ; 
+				nullptr, //const TileBitmap* bitmap ; 
 				{
 					{"You may not", ST77XX_WHITE},
 					{"exit this", ST77XX_WHITE},
@@ -735,7 +843,7 @@ struct Frontier : public GameScreen {
 
 			gGameState.displayManager.setDesiredLayout({
 				"SAFE TRAVELS", // title
-				nullptr, //const uint16_t* bitmap ; 
+				nullptr, //const TileBitmap* bitmap ; 
 				{
 					{"You travel", ST77XX_WHITE},
 					{"into the next", ST77XX_WHITE},
@@ -761,11 +869,10 @@ struct Frontier : public GameScreen {
 } gFrontier;
 
 
-struct LostScreen : public GameScreen {
+struct LostScreen : public TaskScreen {
     bool mMoveBack= true;
-    ScreenList mScreenList;
 
-    virtual void begin() override {
+    virtual ScreenTask run() override {
         const int playerIdx= gGameState.worldState.mCurrentPlayer;
         Player& player = gGameState.worldState.mPlayers[playerIdx];
        
@@ -775,9 +882,9 @@ struct LostScreen : public GameScreen {
         gGameState.soundManager.play(lost_snd, true);
         mMoveBack = (player.mInventory[(int)Inventory::Scout] == 0);
 
-        mScreenList.addScreen({
+        gGameState.displayManager.setDesiredLayout({
             "TERRITORY", // title
-            tile_bitmap_lost, //const uint16_t* bitmap ; 
+            &tile_bitmap_lost, //const TileBitmap* bitmap ; 
             {
                 {"You become lost", ST77XX_WHITE}
             }, //std::vector<TextLine> textLines;
@@ -786,11 +893,12 @@ struct LostScreen : public GameScreen {
             },//std::vector<TextLine> options;
             0 //int selection = 0)      
         });
+        co_await page();
 
         if (!mMoveBack) {
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 "SAVED!", // title
-                tile_bitmap_scout, //const uint16_t* bitmap ; 
+                &tile_bitmap_scout, //const TileBitmap* bitmap ; 
                 {
                     {"Your Scout shows", ST77XX_GREEN},
                     {"the way", ST77XX_GREEN}
@@ -800,55 +908,54 @@ struct LostScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            co_await page();
            
         }
-        
-        // display the screen list
-        mScreenList.nextScreen();
-    }
 
-    virtual void onSelection() override {
-        if (mScreenList.count() > 0) {
-            gGameState.soundManager.play(rotate_snd, true);
-            mScreenList.nextScreen(); 
+        if (mMoveBack) {
+            gGameState.swapScreen(&gMoveBack);
         }
         else {
-            if (mMoveBack) {
-                gGameState.swapScreen(&gMoveBack);
-            }
-            else {
-                gGameState.popScreen(); 
-            }               
+            gGameState.popScreen(); 
         }
     }
 
 } gLostScreen;
 
-struct PlagueScreen : public GameScreen {
-    ScreenList mScreenList;
-
-    virtual void begin() override {
-        const int playerIdx= gGameState.worldState.mCurrentPlayer;
-        Player& player = gGameState.worldState.mPlayers[playerIdx];
-       
-        //player.mLastBuilding = (int)Location::Citadel;
-        player.mTurnCompleted = true;
+struct PlagueScreen : public TaskScreen {
 
-        gGameState.soundManager.play(plague_snd, true);
-
-        mScreenList.addScreen({
+    static ScreenLayout village(bool withOk) {
+        ScreenLayout layout({
             "TERRITORY", // title
-            tile_bitmap_plague, //const uint16_t* bitmap ; 
+            &tile_bitmap_plague, //const TileBitmap* bitmap ; 
             {
                 {"You find a", ST77XX_RED},
                 {"village afflicted", ST77XX_RED},
                 {"with illness", ST77XX_RED}
             }, //std::vector<TextLine> textLines;
-            {
-                { "OK", 0}
-            },//std::vector<TextLine> options;
+            {},//std::vector<TextLine> options;
             0 //int selection = 0)      
         });
+        if (withOk) {
+            layout.addOption("OK", 0);
+        }
+        return layout;
+    }
+
+    virtual ScreenTask run() override {
+        const int playerIdx= gGameState.worldState.mCurrentPlayer;
+        Player& player = gGameState.worldState.mPlayers[playerIdx];
+       
+        //player.mLastBuilding = (int)Location::Citadel;
+        player.mTurnCompleted = true;
+
+        // the village is shown while the sound plays, and can be passed
+        // once it is over
+        const SoundHandle illness = gGameState.soundManager.play(plague_snd, true);
+        co_await show(village(false));
+        co_await sound(illness);
+        gGameState.displayManager.setDesiredLayout(village(true));
+        co_await page();
 
         if (player.mInventory[(int)Inventory::Healer] > 0) {
             const int newWarriors= player.adjustWarriors(2);
@@ -858,9 +965,9 @@ struct PlagueScreen : public GameScreen {
                 gainedWarriors = String(newWarriors) + String(" Warriors");           
             }
 
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 "SAVED!", // title
-                tile_bitmap_healer, //const uint16_t* bitmap ; 
+                &tile_bitmap_healer, //const TileBitmap* bitmap ; 
                 {
                     {"Your Healer", ST77XX_GREEN},
                     {"cured the sick", ST77XX_GREEN},
@@ -870,10 +977,11 @@ struct PlagueScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            co_await page();
 
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 "SAVED!", // title
-                tile_bitmap_warriors, //const uint16_t* bitmap ; 
+                &tile_bitmap_warriors, //const TileBitmap* bitmap ; 
                 {
                     {"You gain", ST77XX_GREEN},
                     {gainedWarriors, ST77XX_GREEN},
@@ -883,6 +991,7 @@ struct PlagueScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            co_await page();
     
         }
         else
@@ -896,9 +1005,9 @@ struct PlagueScreen : public GameScreen {
             }
             String cursedGold = String(lostGold) + String(" Gold");
 
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 "PLAGUE!", // title
-                tile_bitmap_warriors, //const uint16_t* bitmap ; 
+                &tile_bitmap_warriors, //const TileBitmap* bitmap ; 
                 {
                     {"You lost", ST77XX_RED},
                     {changedWarriors, ST77XX_RED},
@@ -908,11 +1017,12 @@ struct PlagueScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            co_await page();
 
             if (lostGold) {
-                mScreenList.addScreen({
+                gGameState.displayManager.setDesiredLayout({
                     "PLAGUE!", // title
-                    tile_bitmap_gold, //const uint16_t* bitmap ; 
+                    &tile_bitmap_gold, //const TileBitmap* bitmap ; 
                     {
                         {"You lost", ST77XX_RED},
                         {cursedGold, ST77XX_RED},
@@ -922,43 +1032,31 @@ struct PlagueScreen : public GameScreen {
                     },//std::vector<TextLine> options;
                     0 //int selection = 0)      
                 });
+                co_await page();
             }
         }
 
-        // display the screen list
-        mScreenList.nextScreen();
-    }
-
-    virtual void onSelection() override {
-        if (mScreenList.count() > 0) {
-            gGameState.soundManager.play(rotate_snd, true);
-            mScreenList.nextScreen(); 
-        }
-        else {
-            gGameState.popScreen();               
-        }
+        gGameState.popScreen();
     }
 
 } gPlagueScreen;
 
-struct CurseGainScreen : public GameScreen {
-    ScreenList mScreenList;
+struct CurseGainScreen : public TaskScreen {
 	int mGainedWarriors = 0;
 	int mGainedGold = 0;
 
-    virtual void begin() override {
+    virtual ScreenTask run() override {
         const int playerIdx= gGameState.worldState.mCurrentPlayer;
         Player& player = gGameState.worldState.mPlayers[playerIdx];
        
-        mScreenList.clear();
 
         {
             const int giftCount = player.adjustWarriors(mGainedWarriors);
             const String giftString = String(mGainedWarriors) + String(" Warriors!");    
             
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 "CAST CURSE", // title
-                tile_bitmap_warriors, //const uint16_t* bitmap ; 
+                &tile_bitmap_warriors, //const TileBitmap* bitmap ; 
                 {
                     {"You Gained", ST77XX_WHITE}, 
                     {giftString, ST77XX_GREEN}
@@ -968,14 +1066,15 @@ struct CurseGainScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            co_await page();
         }
         {
             const int giftCount = player.adjustGold(mGainedGold);
             const String giftString = String(giftCount) + String(" Gold!");
 
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 "CAST CURSE", // title
-                tile_bitmap_gold, //const uint16_t* bitmap ; 
+                &tile_bitmap_gold, //const TileBitmap* bitmap ; 
                 {
                     {"You Gained", ST77XX_WHITE}, 
                     {giftString, ST77XX_GREEN}
@@ -985,23 +1084,10 @@ struct CurseGainScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            co_await page();
         }
-     
-        // display the screen list
-        mScreenList.nextScreen();
-    }
-
-    virtual void onSelection() override {
-        const int playerIdx= gGameState.worldState.mCurrentPlayer;
-        auto& player = gGameState.worldState.mPlayers[playerIdx];
 
-        if (mScreenList.count() > 0) {
-            gGameState.soundManager.play(rotate_snd, true);
-            mScreenList.nextScreen(); 
-        }
-        else {
-            gGameState.popScreen();    
-        }
+        gGameState.popScreen();
     }
 
 } gCurseGainScreen;
@@ -1017,7 +1103,7 @@ struct CursePlayer : public GameScreen {
 		{
 			ScreenLayout screen(
 				"CAST CURSE", // title
-				tile_bitmap_wizard, //const uint16_t* bitmap ; 
+				&tile_bitmap_wizard, //const TileBitmap* bitmap ; 
 				{
 					{"Select player", ST77XX_YELLOW},
 					{"to Curse!", ST77XX_YELLOW}
@@ -1060,16 +1146,14 @@ struct CursePlayer : public GameScreen {
 } gCursePlayer;
 
 
-struct TreasureScreen : public GameScreen {
-    ScreenList mScreenList;
+struct TreasureScreen : public TaskScreen {
     bool mWizardCurse= false;
 
-    virtual void begin() override {
+    virtual ScreenTask run() override {
         const int playerIdx= gGameState.worldState.mCurrentPlayer;
         Player& player = gGameState.worldState.mPlayers[playerIdx];
         mWizardCurse= false;
 
-		mScreenList.clear();
 
         int rand = random(10);
 
@@ -1078,9 +1162,9 @@ struct TreasureScreen : public GameScreen {
             if (player.mInventory[(int)Inventory::Sword] == 0)
 			{
 				player.mInventory[(int)Inventory::Sword] = 1;
-                mScreenList.addScreen({
+                gGameState.displayManager.setDesiredLayout({
                     "REWARD", // title
-                    tile_bitmap_sword, //const uint16_t* bitmap ; 
+                    &tile_bitmap_sword, //const TileBitmap* bitmap ; 
                     {
                         {"You found the", ST77XX_GREEN},
                         {"Dragon Sword", ST77XX_GREEN},
@@ -1090,6 +1174,7 @@ struct TreasureScreen : public GameScreen {
                     },//std::vector<TextLine> options;
                     0 //int selection = 0)      
                 });
+                co_await page();
             }
         }
         else if (rand < 6) 
@@ -1097,9 +1182,9 @@ struct TreasureScreen : public GameScreen {
             if (gGameState.worldState.mPlayers.size() > 1)
 			{
 				mWizardCurse = true;
-				mScreenList.addScreen({
+				gGameState.displayManager.setDesiredLayout({
                     "REWARD", // title
-                    tile_bitmap_wizard, //const uint16_t* bitmap ; 
+                    &tile_bitmap_wizard, //const TileBitmap* bitmap ; 
                     {
                         {"You may cast", ST77XX_GREEN},
                         {"a Curse", ST77XX_GREEN},
@@ -1109,6 +1194,7 @@ struct TreasureScreen : public GameScreen {
                     },//std::vector<TextLine> options;
                     0 //int selection = 0)      
                 });
+				co_await page();
             }
         }
         else if (rand < 7) 
@@ -1116,9 +1202,9 @@ struct TreasureScreen : public GameScreen {
             if (player.mInventory[(int)Inventory::Pegasus] == 0)
 			{
 				player.mInventory[(int)Inventory::Pegasus] = 1;
-                mScreenList.addScreen({
+                gGameState.displayManager.setDesiredLayout({
                     "REWARD", // title
-                    tile_bitmap_pegasus, //const uint16_t* bitmap ; 
+                    &tile_bitmap_pegasus, //const TileBitmap* bitmap ; 
                     {
                         {"You found the", ST77XX_GREEN},
                         {"Pegasus", ST77XX_GREEN},
@@ -1128,6 +1214,7 @@ struct TreasureScreen : public GameScreen {
                     },//std::vector<TextLine> options;
                     0 //int selection = 0)      
                 });
+                co_await page();
             }
         }
 		else if (rand >= 7) {
@@ -1135,9 +1222,9 @@ struct TreasureScreen : public GameScreen {
 			if (player.mInventory[(int)Inventory::BrassKey] == 0 && player.mKingdomCount > 0)
 			{
 				player.mInventory[(int)Inventory::BrassKey] = 1;
-                mScreenList.addScreen({
+                gGameState.displayManager.setDesiredLayout({
                     "REWARD", // title
-                    tile_bitmap_brasskey, //const uint16_t* bitmap ; 
+                    &tile_bitmap_brasskey, //const TileBitmap* bitmap ; 
                     {
                         {"You found a", ST77XX_GREEN},
                         {"Tower Key", ST77XX_GREEN},
@@ -1147,13 +1234,14 @@ struct TreasureScreen : public GameScreen {
                     },//std::vector<TextLine> options;
                     0 //int selection = 0)      
                 });
+                co_await page();
             }
 			else if (player.mInventory[(int)Inventory::SilverKey] == 0 && player.mKingdomCount > 1)
 			{
 				player.mInventory[(int)Inventory::SilverKey] = 1;
-                mScreenList.addScreen({
+                gGameState.displayManager.setDesiredLayout({
                     "REWARD", // title
-                    tile_bitmap_silverkey, //const uint16_t* bitmap ; 
+                    &tile_bitmap_silverkey, //const TileBitmap* bitmap ; 
                     {
                         {"You found a", ST77XX_GREEN},
                         {"Tower Key", ST77XX_GREEN},
@@ -1163,13 +1251,14 @@ struct TreasureScreen : public GameScreen {
                     },//std::vector<TextLine> options;
                     0 //int selection = 0)      
                 });
+                co_await page();
             }
 			else if (player.mInventory[(int)Inventory::GoldKey] == 0 && player.mKingdomCount > 2)
 			{
 				player.mInventory[(int)Inventory::GoldKey] = 1;
-                mScreenList.addScreen({
+                gGameState.displayManager.setDesiredLayout({
                     "REWARD", // title
-                    tile_bitmap_goldkey, //const uint16_t* bitmap ; 
+                    &tile_bitmap_goldkey, //const TileBitmap* bitmap ; 
                     {
                         {"You found a", ST77XX_GREEN},
                         {"Tower Key", ST77XX_GREEN},
@@ -1179,18 +1268,19 @@ struct TreasureScreen : public GameScreen {
                     },//std::vector<TextLine> options;
                     0 //int selection = 0)      
                 });
+                co_await page();
             }
 
 		}
 
-		if (mScreenList.count() == 0) {
+		if (mPages == 0) {
 			int gold = player.adjustGold(random(11) + 10);
 			if (gold > 0) 
 			{
 				String gifteddGold = String(gold) + String(" Gold");
-				mScreenList.addScreen({
+				gGameState.displayManager.setDesiredLayout({
 					"REWARD", // title
-					tile_bitmap_gold, //const uint16_t* bitmap ; 
+					&tile_bitmap_gold, //const TileBitmap* bitmap ; 
 					{
 						{"You found", ST77XX_GREEN},
 						{gifteddGold, ST77XX_GREEN},
@@ -1200,27 +1290,22 @@ struct TreasureScreen : public GameScreen {
 					},//std::vector<TextLine> options;
 					0 //int selection = 0)      
 				});
+				co_await page();
 			}
 		}
-        
-        // display the screen list
-        mScreenList.nextScreen();
-    }
 
-    virtual void onSelection() override {
-        if (mScreenList.count() > 0) {
-            gGameState.soundManager.play(rotate_snd, true);
-            mScreenList.nextScreen(); 
+        // nothing found still waits for Select
+        if (mPages == 0) {
+            co_await selection();
+        }
+
+        if (mWizardCurse) {
+            mWizardCurse = false;
+            // goto curse screen
+            gGameState.swapScreen(&gCursePlayer);
         }
         else {
-			if (mWizardCurse) {
-				mWizardCurse = false;
-				// goto curse screen
-				gGameState.swapScreen(&gCursePlayer);
-			}
-			else {
-				gGameState.popScreen();   
-			}
+            gGameState.popScreen();   
         }
     }
 
@@ -1244,7 +1329,7 @@ struct RunAway : public GameScreen {
 			gGameState.soundManager.play(player_hit_snd, true);
 			gGameState.displayManager.setDesiredLayout({
 				"RUN AWAY!", // title
-				tile_bitmap_warrior, //const uint16_t* bitmap ; 
+				&tile_bitmap_warrior, //const TileBitmap* bitmap ; 
 				{
 					{"You lost one", ST77XX_RED},
 					{"more Warrior!", ST77XX_RED}
@@ -1260,7 +1345,7 @@ struct RunAway : public GameScreen {
 			gGameState.soundManager.play(pegasus_snd, true);
 			gGameState.displayManager.setDesiredLayout({
 				"RUN AWAY!", // title
-				nullptr, //const uint16_t* bitmap ; 
+				nullptr, //const TileBitmap* bitmap ; 
 				{
 					{"You Escaped!", ST77XX_YELLOW},
 				}, //std::vector<TextLine> textLines;
@@ -1280,8 +1365,7 @@ struct RunAway : public GameScreen {
 } gRunAway;
 
 
-struct BattleScreen : public GameScreen {
-    ScreenList mScreenList;
+struct BattleScreen : public TaskScreen {
     int32_t mBrigands = 1;
     bool mFinalBattle= false;
 
@@ -1298,10 +1382,9 @@ struct BattleScreen : public GameScreen {
         return 25 + ( wars / ( 4 * brigs) );
     }
 
-    virtual void begin() override {
+    virtual ScreenTask run() override {
         const int playerIdx= gGameState.worldState.mCurrentPlayer;
         Player& player = gGameState.worldState.mPlayers[playerIdx];
-        mScreenList.clear();
 
         int minWarriors = 1;
         if (gGameState.worldState.mPlayers.size() == 1) {
@@ -1333,9 +1416,10 @@ struct BattleScreen : public GameScreen {
 
         int warriors = player.mInventory[(int)Inventory::Warriors];
 
-        mScreenList.addScreen({
+        // the round's outcome moves on by itself, or on Select
+        gGameState.displayManager.setDesiredLayout({
             title, // title
-            tile_bitmap_brigands, //const uint16_t* bitmap ; 
+            &tile_bitmap_brigands, //const TileBitmap* bitmap ; 
             {
                 {String(mBrigands), brigColor}
             }, //std::vector<TextLine> textLines;
@@ -1344,12 +1428,15 @@ struct BattleScreen : public GameScreen {
             },//std::vector<TextLine> options;
             0 //int selection = 0)      
         });
+        co_await page(2500);
+
+        int selected = -1;
 
         if (warriors == minWarriors) {
             // they win
-             mScreenList.addScreen({
+             gGameState.displayManager.setDesiredLayout({
                 "BATTLE LOST", // title
-                tile_bitmap_warriors, //const uint16_t* bitmap ; 
+                &tile_bitmap_warriors, //const TileBitmap* bitmap ; 
                 {
                     {String(warriors), warColor}
                 }, //std::vector<TextLine> textLines;
@@ -1358,12 +1445,13 @@ struct BattleScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+             selected = co_await page();
         }
         else if (mBrigands == 0) {
             // you wim
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 "BATTLE WON", // title
-                tile_bitmap_warriors, //const uint16_t* bitmap ; 
+                &tile_bitmap_warriors, //const TileBitmap* bitmap ; 
                 {
                     {String(warriors), warColor}
                 }, //std::vector<TextLine> textLines;
@@ -1372,12 +1460,13 @@ struct BattleScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            selected = co_await page();
         }
         else {
             // battle continues
-            mScreenList.addScreen({
+            gGameState.displayManager.setDesiredLayout({
                 title, // title
-                tile_bitmap_warriors, //const uint16_t* bitmap ; 
+                &tile_bitmap_warriors, //const TileBitmap* bitmap ; 
                 {
                     {String(warriors), warColor}
                 }, //std::vector<TextLine> textLines;
@@ -1387,52 +1476,33 @@ struct BattleScreen : public GameScreen {
                 },//std::vector<TextLine> options;
                 0 //int selection = 0)      
             });
+            selected = co_await page();
         }
 
-        // display the screen list
-        mScreenList.nextScreen();
-    }
-
-    virtual void update(int32_t elapsedMS) {
-        if (mScreenList.count() > 0 && elapsedMS > 2500) {
-            // display the screen list
-            gGameState.soundManager.play(rotate_snd, true);
-            mScreenList.nextScreen();
-        }
-    }
-
-    virtual void onSelection() override {
-        if (mScreenList.count() > 0) {
-            gGameState.soundManager.play(rotate_snd, true);
-            mScreenList.nextScreen(); 
-        }
-        else {
-            TextLine mSelectedOption = gGameState.displayManager.getSelectedOption();
-            if (mSelectedOption.mValue == 2) // Battle ended in loss
-            {
-                gGameState.popScreen(); 
-            }
-            else if (mSelectedOption.mValue == 3) // Battle ended in victory
-            {            
-                if (mFinalBattle) {
-                    // Victory screen!
-                	gGameState.swapScreen(&gVictory); 
-					return;
-                }  
+        if (selected == 2) // Battle ended in loss
+        {
+            gGameState.popScreen(); 
+        }
+        else if (selected == 3) // Battle ended in victory
+        {            
+            if (mFinalBattle) {
+                // Victory screen!
+                gGameState.swapScreen(&gVictory); 
+            }  
+            else {
                 // Treasure
                 gGameState.swapScreen(&gTreasureScreen); 
-				return;
-            }
-            else if (mSelectedOption.mValue == 1) // Run Away!
-            {              
-                // Run screen
-                gGameState.swapScreen(&gRunAway); 
-            }
-            else {
-                // continue fight!
-                gGameState.swapScreen(this); 
             }
         }
+        else if (selected == 1) // Run Away!
+        {              
+            // Run screen
+            gGameState.swapScreen(&gRunAway); 
+        }
+        else {
+            // continue fight!
+            gGameState.swapScreen(this); 
+        }
     }
 
 } gBattleScreen;
@@ -1499,7 +1569,7 @@ struct BattleStart : public GameScreen {
 
         gGameState.displayManager.setDesiredLayout({
             "ATTACKED!", // title
-            tile_bitmap_brigands, //const uint16_t* bitmap ; 
+            &tile_bitmap_brigands, //const TileBitmap* bitmap ; 
             {
                 {String(brigands), ST77XX_RED}
             }, //std::vector<TextLine> textLines;
@@ -1550,7 +1620,7 @@ struct TerritoryMove : public GameScreen {
 
         gGameState.displayManager.setDesiredLayout({
             "TERRITORY", // title
-            nullptr, //const uint16_t* bitmap ; 
+            nullptr, //const TileBitmap* bitmap ; 
             {   
                 {"Safe move.", ST77XX_WHITE}
             }, //std::vector<TextLine> textLines;
@@ -1569,8 +1639,7 @@ struct TerritoryMove : public GameScreen {
 } gTerritoryMove;
 
 
-struct TombRuin : public GameScreen {
-    ScreenList mScreenList;
+struct TombRuin : public TaskScreen {
 	enum Outcome {
 		Empty=0,
 		Reward,
@@ -1578,7 +1647,8 @@ struct TombRuin : public GameScreen {
 	};
 	Outcome mOutcome = Outcome::Empty;
 
-    virtual void begin() override {
+    virtual ScreenTask run() override {
+        const uint32_t startedAt = millis();
         const int playerIdx= gGameState.worldState.mCurrentPlayer;
         Player& player = gGameState.worldState.mPlayers[playerIdx];
        
@@ -1588,37 +1658,9 @@ struct TombRuin : public GameScreen {
         player.mLocation = (int)Location::Ruin;
 		player.mTurnCompleted = true;
 
-        //gGameState.soundManager.play(rotate_snd, true);
-		mScreenList.clear();
-
-        mScreenList.addScreen({
-            "EXPLORING", // title
-            nullptr, //const uint16_t* bitmap ; 
-            {   
-                {"You look inside", ST77XX_WHITE},
-				{"the darkness...", ST77XX_WHITE}
-            }, //std::vector<TextLine> textLines;
-            {},//std::vector<TextLine> options;
-            0 //int selection = 0)      
-        });
-
         if (randomRoll < 2) {
             mOutcome = Outcome::Empty;
 			gGameState.soundManager.play(tomb_nothing_snd, true);
-			
-			mScreenList.addScreen({
-				"EXPLORING", // title
-				nullptr, //const uint16_t* bitmap ; 
-				{   
-					{"You find", ST77XX_WHITE},
-					{"nothing", ST77XX_WHITE}
-				}, //std::vector<TextLine> textLines;
-				{
-					{"OK", 0}
-				},//std::vector<TextLine> options;
-				0 //int selection = 0)      
-			});
-
         }
         else if (randomRoll == 2) {
             mOutcome = Outcome::Reward;
@@ -1629,53 +1671,47 @@ struct TombRuin : public GameScreen {
 			gGameState.soundManager.play(tomb_battle_snd, true);
         }
 
-		mScreenList.nextScreen();
-    }
-
-    virtual void update(int32_t elapsedMS) {
-        if (elapsedMS > 3000) 
-		{
-			if (mScreenList.count() > 0) 
-			{
-            	// display the screen list
-				gGameState.inputManager.clear();
-
-            	mScreenList.nextScreen();
-			}
-			else if (gGameState.displayManager.getOptionCount() == 0)
-			{
-				if (mOutcome == Outcome::Battle) {
-					gBattleStart.mFinalBattle = false;
-					gGameState.swapScreen(&gBattleStart); 
-					return;
-				}
-				else if (mOutcome == Outcome::Reward) {
-					gGameState.swapScreen(&gTreasureScreen); 
-					return;
-				}
+        gGameState.displayManager.setDesiredLayout({
+            "EXPLORING", // title
+            nullptr, //const TileBitmap* bitmap ; 
+            {   
+                {"You look inside", ST77XX_WHITE},
+				{"the darkness...", ST77XX_WHITE}
+            }, //std::vector<TextLine> textLines;
+            {},//std::vector<TextLine> options;
+            0 //int selection = 0)      
+        });
+        co_await shown();
+        // the outcome comes 3s after the screen started, however long
+        // drawing it took
+        co_await delay(std::max<int32_t>(3000 - (int32_t)(millis() - startedAt), 0));
 
-				gGameState.popScreen();    
-			}
+		if (mOutcome == Outcome::Battle) {
+			gBattleStart.mFinalBattle = false;
+			gGameState.swapScreen(&gBattleStart); 
+			co_return;
+		}
+		else if (mOutcome == Outcome::Reward) {
+			gGameState.swapScreen(&gTreasureScreen); 
+			co_return;
 		}
-    }
 
-    virtual void onSelection() override {
-        if (mScreenList.count() > 0) {
-            mScreenList.nextScreen(); 
-        }
-        else {
-			if (mOutcome == Outcome::Battle) {
-				gBattleStart.mFinalBattle = false;
-				gGameState.swapScreen(&gBattleStart); 
-				return;
-			}
-			else if (mOutcome == Outcome::Reward) {
-				gGameState.swapScreen(&gTreasureScreen); 
-				return;
-			}
+		gGameState.inputManager.clear();
+		gGameState.displayManager.setDesiredLayout({
+			"EXPLORING", // title
+			nullptr, //const TileBitmap* bitmap ; 
+			{   
+				{"You find", ST77XX_WHITE},
+				{"nothing", ST77XX_WHITE}
+			}, //std::vector<TextLine> textLines;
+			{
+				{"OK", 0}
+			},//std::vector<TextLine> options;
+			0 //int selection = 0)      
+		});
+		co_await page();
 
-            gGameState.popScreen();    
-        }
+        gGameState.popScreen();    
     }
 
 } gTombRuin;
@@ -1694,7 +1730,7 @@ struct UsePegasus : public GameScreen {
  
         gGameState.displayManager.setDesiredLayout({
             "PEGASUS", // title
-            nullptr, //const uint16_t* bitmap ; 
+            nullptr, //const TileBitmap* bitmap ; 
             {
                 {"Fly to any", ST77XX_WHITE},
                 {"space in this", ST77XX_WHITE},
@@ -1726,7 +1762,7 @@ struct WrongKey : public GameScreen {
 
         gGameState.displayManager.setDesiredLayout({
             "KEY RIDDLE", // title
-            nullptr, //const uint16_t* bitmap ; 
+            nullptr, //const TileBitmap* bitmap ; 
             {
                 {"Wrong Answer", ST77XX_WHITE},
             }, //std::vector<TextLine> textLines;
@@ -1754,7 +1790,7 @@ struct SecondKey : public GameScreen {
 
         ScreenLayout screen(
             "KEY RIDDLE", // title
-            nullptr, //const uint16_t* bitmap ; 
+            nullptr, //const TileBitmap* bitmap ; 
             {
                 {"Which Key", ST77XX_WHITE},
                 {"goes second?", ST77XX_WHITE},
@@ -1808,7 +1844,7 @@ struct FirstKey : public GameScreen {
 
         gGameState.displayManager.setDesiredLayout({
             "KEY RIDDLE", // title
-            nullptr, //const uint16_t* bitmap ; 
+            nullptr, //const TileBitmap* bitmap ; 
             {
                 {"Which Key", ST77XX_WHITE},
                 {"goes first?", ST77XX_WHITE},
@@ -1849,7 +1885,7 @@ struct BazaarClosed : public GameScreen {
 
         gGameState.displayManager.setDesiredLayout({
             "GO AWAY", // title
-            tile_bitmap_bazaar, //const uint16_t* bitmap ; 
+            &tile_bitmap_bazaar, //const TileBitmap* bitmap ; 
             {
                 {"No Deal", ST77XX_WHITE},
             }, //std::vector<TextLine> textLines;
@@ -1868,14 +1904,14 @@ struct BazaarClosed : public GameScreen {
 
 struct Bazaar : public GameScreen {
 	struct StoreItem {
-		const uint16_t* bitmap;
+		const TileBitmap* bitmap;
 		int inventorySlot;
 		int minPrice;
 		int limit;
 		int price;
 
 		StoreItem(
-			const uint16_t* _bitmap,
+			const TileBitmap* _bitmap,
 			int _inventorySlot,
 			int _minPrice,
 			int _limit,
@@ -1895,11 +1931,11 @@ struct Bazaar : public GameScreen {
 		mItemIdx = 0;
 		mItems.clear();
 
-		mItems.emplace_back(tile_bitmap_warrior, (int)Inventory::Warriors, 4, 99, random(7) + 4);
-		mItems.emplace_back(tile_bitmap_food, (int)Inventory::Food, 1, 99, 1);
-		mItems.emplace_back(tile_bitmap_beast, (int)Inventory::Beast, 4, 1, random(11) + 15);
-		mItems.emplace_back(tile_bitmap_scout, (int)Inventory::Scout, 4, 1, random(11) + 15);
-		mItems.emplace_back(tile_bitmap_healer, (int)Inventory::Healer, 4, 1, random(11) + 15);
+		mItems.emplace_back(&tile_bitmap_warrior, (int)Inventory::Warriors, 4, 99, random(7) + 4);
+		mItems.emplace_back(&tile_bitmap_food, (int)Inventory::Food, 1, 99, 1);
+		mItems.emplace_back(&tile_bitmap_beast, (int)Inventory::Beast, 4, 1, random(11) + 15);
+		mItems.emplace_back(&tile_bitmap_scout, (int)Inventory::Scout, 4, 1, random(11) + 15);
+		mItems.emplace_back(&tile_bitmap_healer, (int)Inventory::Healer, 4, 1, random(11) + 15);
         gGameState.soundManager.play(bazaar_snd, true);
 	}
 
@@ -1915,7 +1951,7 @@ struct Bazaar : public GameScreen {
 
         ScreenLayout screen(
             "BAZAAR", // title
-            item.bitmap, //const uint16_t* bitmap ; 
+            item.bitmap, //const TileBitmap* bitmap ; 
             {
                 {String("Cost: ") + String(item.price) + String(" Gold: ") + String(playerGold), ST77XX_WHITE},
             }, //std::vector<TextLine> textLines;
@@ -2017,77 +2053,80 @@ struct PlayerTurn : public GameScreen {
     TextLine mSelectedOption;
 
     virtual void begin() override {
-        const int playerIdx= gGameState.worldState.mCurrentPlayer;
-        auto& player = gGameState.worldState.mPlayers[playerIdx];
-
         if (checkForEndGame()) {
             return;
         }
+        gGameState.displayManager.setDesiredLayout(buildLayout());
+    }
+
+    // the screen begin() shows, without the end of game check, so it can be
+    // laid out and compiled ahead of time
+    ScreenLayout buildLayout() {
+        ScreenLayout screen;
+        const int playerIdx= gGameState.worldState.mCurrentPlayer;
+        auto& player = gGameState.worldState.mPlayers[playerIdx];
 
         String Title = "PLAYER ";
         Title += String(playerIdx+1);
 
-        gGameState.displayManager.setTitle(Title);
-        gGameState.displayManager.clearBitmaps();
-        gGameState.displayManager.clearInfo();
+        screen.mTitle = Title;
 
         if (player.mInventory[(int)Inventory::Food] == 0) 
         {
-            gGameState.displayManager.addInfo("A Warrior Starved!", ST77XX_RED);
+            screen.addInfo("A Warrior Starved!", ST77XX_RED);
         }
         else if (player.mInventory[(int)Inventory::Food] < 5) 
         {
-            gGameState.displayManager.addInfo("Food is low!", ST77XX_YELLOW);
+            screen.addInfo("Food is low!", ST77XX_YELLOW);
         }
         
 		if (!mPegasusLanding) {
 			if (player.mTurnCompleted) 
 			{
-				gGameState.displayManager.addInfo("End Your Turn", ST77XX_WHITE);
+				screen.addInfo("End Your Turn", ST77XX_WHITE);
 			}
 			else 
 			{
-				gGameState.displayManager.addInfo("Select Action:", ST77XX_WHITE);
+				screen.addInfo("Select Action:", ST77XX_WHITE);
 			}
 		}
 		else {
-			gGameState.displayManager.addInfo("Choose Landing:", ST77XX_WHITE);
+			screen.addInfo("Choose Landing:", ST77XX_WHITE);
 		}
-        gGameState.displayManager.clearOptions();
         
         if (!player.mTurnCompleted) 
         {
             if (!mPegasusLanding && player.mInventory[(int)Inventory::Pegasus] > 0)
             {
-                gGameState.displayManager.addOption("Use Pegasus", (int)Action::UsePegasus);     
+                screen.addOption("Use Pegasus", (int)Action::UsePegasus);     
             }
 
-            gGameState.displayManager.addOption("Territory", (int)Action::Territory);
+            screen.addOption("Territory", (int)Action::Territory);
 
             if (player.mLocation == (int)Location::Territory) 
             {
-                gGameState.displayManager.addOption("Frontier", (int)Action::Frontier);     
+                screen.addOption("Frontier", (int)Action::Frontier);     
             }
 
             if (player.mLocation == (int)Location::Citadel || 
                 (player.mLocation == (int)Location::Territory && (player.mKingdomCount == 0 || player.mKingdomCount > 3))) 
             {
-                gGameState.displayManager.addOption("Citadel", (int)Action::Citadel);     
+                screen.addOption("Citadel", (int)Action::Citadel);     
             }
 
             if (player.mLocation == (int)Location::Sanctuary || player.mLocation == (int)Location::Territory) 
             {
-                gGameState.displayManager.addOption("Sanctuary", (int)Action::Sanctuary);     
+                screen.addOption("Sanctuary", (int)Action::Sanctuary);     
             }
 
             if (player.mLocation == (int)Location::Ruin || player.mLocation == (int)Location::Territory) 
             {
-                gGameState.displayManager.addOption("Tomb/Ruin", (int)Action::TombRuin);     
+                screen.addOption("Tomb/Ruin", (int)Action::TombRuin);     
             }
             
             if (player.mLocation == (int)Location::Bazaar || player.mLocation == (int)Location::Territory) 
             {
-                gGameState.displayManager.addOption("Bazaar", (int)Action::Bazaar);     
+                screen.addOption("Bazaar", (int)Action::Bazaar);     
             }
 
             if (player.mLocation == (int)Location::DarkTower || player.mLocation == (int)Location::Territory) 
@@ -2097,27 +2136,28 @@ struct PlayerTurn : public GameScreen {
 					&& player.mInventory[(int)Inventory::GoldKey] > 0
 					&& player.mKingdomCount > 3)
 				{
-                	gGameState.displayManager.addOption("DarkTower", (int)Action::DarkTower);     
+                	screen.addOption("DarkTower", (int)Action::DarkTower);     
 				}
             }
         }
         
-		gGameState.displayManager.setSelection(0);
+		screen.mSelection = 0;
 
 		if (!mPegasusLanding) {
             if (!player.mTurnCompleted)
             {
-        	gGameState.displayManager.addOption("Inventory", (int)Action::ViewInventory);
+        	screen.addOption("Inventory", (int)Action::ViewInventory);
             }
 
 			if (player.mTurnCompleted)
 			{
-        		gGameState.displayManager.addOption("End Turn", (int)Action::EndTurn);
-				gGameState.displayManager.setSelection(gGameState.displayManager.getOptionCount()-1);
+        		screen.addOption("End Turn", (int)Action::EndTurn);
+				screen.mSelection = screen.mOptions.size()-1;
 			}
 		}
 
 		mPegasusLanding= false;
+        return screen;
     };
 
     virtual void onSelection() override 
@@ -2261,7 +2301,7 @@ struct HomeKingdom : public AutoConfirmScreen {
 
         ScreenLayout screenLayout({
             Title, // title
-            nullptr, //const uint16_t* bitmap ; 
+            nullptr, //const TileBitmap* bitmap ; 
             {
                 {"What is your", ST77XX_WHITE}, 
                 {"home kingdom?", ST77XX_WHITE}
@@ -2290,39 +2330,113 @@ struct HomeKingdom : public AutoConfirmScreen {
 } gHomeKingdom;
 
 
+// Hands the turn to the next player in stages run from GameState::update(),
+// so nothing waits on the end of turn sound. The bookkeeping is done as soon
+// as the sound starts, and the next player's screen is compiled while it
+// plays, so once it ends that screen only has to be drawn.
+struct TurnTransition {
+    enum class Stage : uint8_t {
+        Idle,
+        Bookkeeping,   // the sound is playing, update the next player
+        WaitForSound,  // the next screen is ready, show it once the sound ends
+    };
+
+    Stage mStage = Stage::Idle;
+    bool mSoundFinished = false;
+    int mPlayerIndex = 0;
+    GameScreen* mNextScreen = nullptr;
+
+    void start(int playerIndex) {
+        mPlayerIndex = playerIndex;
+        mNextScreen = nullptr;
+        mSoundFinished = false;
+        mStage = Stage::Bookkeeping;
+
+        // Select is held off until the sound ends, since it waits for the
+        // song, and it is queued so the food sounds can be queued after it
+        SoundHandle sound = gGameState.soundManager.queue(end_turn_snd, true);
+        gGameState.soundManager.onFinished(sound, &sound_finished, this);
+    }
+
+    bool hasWork() const {
+        return mStage == Stage::Bookkeeping || (mStage == Stage::WaitForSound && mSoundFinished);
+    }
+
+    void update() {
+        if (mStage == Stage::Bookkeeping) {
+            bookkeeping();
+            mStage = Stage::WaitForSound;
+        }
+        // the sound may have had no voice, and be over already
+        if (mStage == Stage::WaitForSound && mSoundFinished) {
+            present();
+        }
+    }
+
+    void bookkeeping() {
+        gGameState.worldState.mCurrentPlayer = mPlayerIndex;
+        auto& player = gGameState.worldState.mPlayers[mPlayerIndex];
+
+        player.mTurnCompleted = false;
+        if (!isValidKingdom(player.mHomeKingdom)) {
+            mNextScreen = &gHomeKingdom;
+        }
+        else {
+            // queued, so they are heard after the end of turn sound
+            int foodRemaining = player.consumeFood();
+            if (foodRemaining == 0 && player.adjustWarriors(-1) != 0) {
+                gGameState.soundManager.queue(plague_snd, true);
+            }
+            else if (foodRemaining < 5) {
+                gGameState.soundManager.queue(starving_snd, true);
+            }
+            mNextScreen = &gPlayerTurnScreen;
+
+            // the old screen stays up until the sound ends
+            gGameState.displayManager.prepare(gPlayerTurnScreen.buildLayout());
+        }
+    }
+
+    void present() {
+        mStage = Stage::Idle;
+        if (mNextScreen == &gHomeKingdom) {
+            gGameState.pushScreen(&gHomeKingdom);
+        }
+        else {
+            gGameState.setActiveScreen(&gPlayerTurnScreen);
+        }
+    }
+
+    static void sound_finished(void* context) {
+        ((TurnTransition*)context)->mSoundFinished = true;
+    }
+} gTurnTransition;
+
 void playerStartTurn(int playerIndex) 
 {
-    if (playerIndex < 0 || playerIndex >= gGameState.worldState.mPlayers.size()) 
+    if (playerIndex < 0 || playerIndex >= (int)gGameState.worldState.mPlayers.size()) 
     {
         playerIndex = 0;
     }
  
 	gPlayerTurnScreen.mPegasusLanding= false;
+    gTurnTransition.start(playerIndex);
+};
 
-    gGameState.soundManager.play(end_turn_snd, true);
-    while(gGameState.soundManager.isPlaying()) {
-        delay(500);
-        gGameState.soundManager.update();
-    }
-    gGameState.worldState.mCurrentPlayer = playerIndex;
-    auto& player = gGameState.worldState.mPlayers[playerIndex];
-    
-    player.mTurnCompleted = false;
-    if (!isValidKingdom(player.mHomeKingdom)) {
-        gGameState.pushScreen(&gHomeKingdom);
-        return;
-    }
+void updateTurnTransition()
+{
+    gTurnTransition.update();
+}
 
-    int foodRemaining = gGameState.worldState.mPlayers[playerIndex].consumeFood();
-    if (foodRemaining == 0 && gGameState.worldState.mPlayers[playerIndex].adjustWarriors(-1) != 0) {
-        gGameState.soundManager.play(plague_snd, true);
-    }
-    else if (foodRemaining < 5) {
-        gGameState.soundManager.play(starving_snd, true);
-    }
-    gGameState.setActiveScreen(&gPlayerTurnScreen);    
+bool hasTurnTransitionWork()
+{
+    return gTurnTransition.hasWork();
+}
 
-};
+bool isTurnTransitionUnderway()
+{
+    return gTurnTransition.mStage != TurnTransition::Stage::Idle;
+}
 
 
 //
@@ -2419,7 +2533,7 @@ struct StartupScreen : public GameScreen {
         gGameState.inputManager.clear();
     
         gGameState.displayManager.setTitle("Welcome");
-        gGameState.displayManager.setBitmapAndValue(tile_bitmap_logo, -1);
+        gGameState.displayManager.setBitmapAndValue(&tile_bitmap_logo, -1);
         gGameState.displayManager.clearInfo();
         gGameState.displayManager.addInfo("Mini Tower Version", ST77XX_WHITE);
         gGameState.displayManager.addInfo("Are you ready?", ST77XX_WHITE);
@@ -2436,6 +2550,27 @@ struct StartupScreen : public GameScreen {
 } gStartupScreen;
 
 
+// every screen that runs a task, each holds at most one
+static TaskScreen* const sTaskScreens[] = {
+    &gPlayerCursed, &gCitadelScreen, &gPlayerInventory, &gDragonScreen, &gLostScreen,
+    &gPlagueScreen, &gCurseGainScreen, &gTreasureScreen, &gBattleScreen, &gTombRuin,
+};
+static_assert(sizeof(sTaskScreens) / sizeof(sTaskScreens[0]) <= SCREEN_TASK_FRAMES,
+              "a task screen without a frame, raise SCREEN_TASK_FRAMES");
+
+void checkScreenTaskFrames() {
+    // a task doesn't run until it is first resumed, so this only takes
+    // each frame, and the task run() returns gives it straight back. One
+    // too big for the pool aborts here.
+    for (TaskScreen* screen : sTaskScreens) {
+        screen->run();
+    }
+    Serial.print(F("Screen task frames: largest "));
+    Serial.print((int)ScreenTask::getLargestFrame());
+    Serial.print(F(" bytes, pool frames "));
+    Serial.println((int)SCREEN_TASK_FRAME_SIZE);
+}
+
 GameScreen* getStartupScreen() {
     return &gStartupScreen;
 }
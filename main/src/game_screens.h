@@ -6,6 +6,9 @@ struct GameState;
 struct GameScreen {
     virtual void begin() {}
     virtual void update(int32_t elapsedMS) {}
+    // ms until update() has something to do on its own, -1 if only input
+    // or a sound can change anything
+    virtual int32_t nextUpdateIn(int32_t /*elapsedMS*/) { return -1; }
     virtual void onOptionChanged() {}
     virtual void onSelection() {}
     virtual void confirm() {}
@@ -16,6 +19,20 @@ GameScreen* getStartupScreen();
 GameScreen* getConfirmOrDenyScreen();
 GameScreen* setupConfirmOrDenyScreen(const String& title, const String& info);
 
+// points the sounds and tiles at the asset pack, when they aren't
+// compiled in, false if any are missing
+bool loadAssets();
+// measures every screen task's frame as this build lays it out, and aborts
+// if any is too big for the pool
+void checkScreenTaskFrames();
+
+// runs the next stage of a turn changing hands, if one is under way
+void updateTurnTransition();
+// true when updateTurnTransition() has a stage ready to run
+bool hasTurnTransitionWork();
+// true from playerStartTurn() until the next player's screen is up
+bool isTurnTransitionUnderway();
+
 void playBeep();
 void playErrorSound();
 
@@ -1,13 +1,21 @@
 #include <Arduino.h>
 #include "game_state.h"
 #include "game_screens.h"
+#include "screen_task.h"
 
 GameState gGameState;
 
 void GameState::setup() {
-    inputManager.setup(1,3,7,5);
+    eventLoop.setup();
+    inputManager.setup(1,3,7,30);
+    inputManager.setWake(&EventLoop::input_isr, &eventLoop);
+    soundManager.setWake(&EventLoop::sound_callback, &eventLoop);
     soundManager.setup(DAC1);
     displayManager.setup();
+    if (!loadAssets()) {
+        Serial.println(F("Assets missing, flash the asset pack"));
+    }
+    checkScreenTaskFrames();
     
     reset();
 }  
@@ -23,10 +31,28 @@ void GameState::reset() {
 }  
 
 void GameState::update() {
-    displayManager.update();   
+    // a sound ending can finish a turn changing hands
     soundManager.update();
-    inputManager.update();
-    InputState inputs= inputManager.ReadInputState();
+    updateTurnTransition();
+
+    // 'a' over serial dumps the audio timing, 'l' the main loop passes and
+    // the screen task frames
+    if (Serial.available() > 0) {
+        const int command = Serial.read();
+        if (command == 'a') {
+            soundManager.dumpTiming(Serial);
+        }
+        else if (command == 'l') {
+            Serial.print(F("Loop passes: "));
+            Serial.print((int)eventLoop.getPassCount());
+            Serial.print(F(", woken by events: "));
+            Serial.println((int)eventLoop.getEventCount());
+            Serial.print(F("Screen task frames used: "));
+            Serial.print(ScreenTask::getFramesInUse());
+            Serial.print(F(", largest: "));
+            Serial.println((int)ScreenTask::getLargestFrame());
+        }
+    }
 
     GameScreen* activeScreen = getActiveScreen();
 
@@ -39,33 +65,49 @@ void GameState::update() {
         activeScreen->update(elapsedTime);
     }
 
-    if (inputs.isPressed(Button::Up))
-    {
-        playBeep(); 
-
-        displayManager.setSelection(displayManager.getSelection() - 1);
-        if (mConfirmScreen)
-        {
-            mConfirmScreen->onOptionChanged();
-        }
-        else if (activeScreen) {
-            activeScreen->onOptionChanged();
-        }
+    // the input is handled before the frame is drawn, so a press shows up
+    // in this pass rather than waiting out a whole frame
+    if (isTurnTransitionUnderway()) {
+        // the old screen stays up while the turn changes hands, but the
+        // current player is already the next one, so it takes no input. A
+        // button still held then doesn't repeat into the next screen.
+        inputManager.clear();
     }
-    else if (inputs.isPressed(Button::Down))
+    else {
+        inputManager.update();
+        handleInput(inputManager.ReadInputState());
+    }
+
+    soundManager.setDisplayBusy(true);
+    displayManager.update();   
+    soundManager.setDisplayBusy(false);
+}
+
+void GameState::handleInput(InputState inputs) {
+    GameScreen* activeScreen = getActiveScreen();
+
+    // every up and down since the last pass, presses and repeats, is one
+    // move, so a held button that outruns the screen still only draws once
+    const int move = inputs.getCount(Button::Down) - inputs.getCount(Button::Up);
+    if (move != 0)
     {
-        playBeep();     
-        
-        displayManager.setSelection(displayManager.getSelection() + 1);
-        if (mConfirmScreen)
-        {
-            mConfirmScreen->onOptionChanged();
-        }
-        else if (activeScreen) {
-            activeScreen->onOptionChanged();
+        const int selection = displayManager.getSelection();
+        displayManager.setSelection(selection + move);
+        // held against the end of the list it stays quiet
+        if (displayManager.getSelection() != selection) {
+            playBeep(); 
+
+            if (mConfirmScreen)
+            {
+                mConfirmScreen->onOptionChanged();
+            }
+            else if (activeScreen) {
+                activeScreen->onOptionChanged();
+            }
         }
     }
-    else if (inputs.isPressed(Button::Select))
+
+    if (inputs.isPressed(Button::Select))
     {
         if (soundManager.isWaitingForSong()) {
             // ignore the input;
@@ -103,6 +145,39 @@ void GameState::update() {
     }
 }
 
+void GameState::waitForEvents() {
+    // a frame that is still being drawn, a layout that changed this pass,
+    // or the next stage of a turn changing hands carries on right away
+    if (displayManager.hasWork() || hasTurnTransitionWork()) {
+        eventLoop.wakeNow();
+    }
+    // a press still waiting to be read, or one that is still settling
+    if (inputManager.hasPresses()) {
+        eventLoop.wakeNow();
+    }
+    const int32_t settle = inputManager.nextUpdateIn();
+    if (settle >= 0) {
+        eventLoop.wakeIn(settle);
+    }
+
+    // finished sounds are reported once they have played out
+    const int64_t soundEnd = soundManager.getNextEndTime();
+    if (soundEnd != 0) {
+        const int64_t wait = soundEnd - esp_timer_get_time();
+        eventLoop.wakeIn(wait > 0 ? (uint32_t)((wait + 999) / 1000) : 0);
+    }
+
+    GameScreen* screen = mConfirmScreen ? mConfirmScreen : getActiveScreen();
+    if (screen) {
+        const int32_t due = screen->nextUpdateIn(millis() - mScreenStartTime);
+        if (due >= 0) {
+            eventLoop.wakeIn(due);
+        }
+    }
+
+    eventLoop.wait();
+}
+
 void GameState::setActiveScreen(GameScreen* screen) {
     swapScreen(screen);
 } 
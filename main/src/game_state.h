@@ -5,6 +5,7 @@
 #include "input_manager.h"
 #include "world_state.h"
 #include "display_manager.h"
+#include "event_loop.h"
 #include <vector>
 
 struct GameScreen;
@@ -14,6 +15,7 @@ struct GameState {
     SoundManager soundManager;
     DisplayManager displayManager;
     WorldState worldState; 
+    EventLoop eventLoop;
 
     std::vector<GameScreen*> mActiveScreens;
     GameScreen* mConfirmScreen = nullptr;
@@ -23,6 +25,8 @@ struct GameState {
     void reset();
     
     void update();
+    // sleeps until a button, a sound, or whatever is due next on screen
+    void waitForEvents();
     void setActiveScreen(GameScreen* screen);
     void confirmOrDeny(const String& title, const String& info);
 
@@ -36,6 +40,7 @@ struct GameState {
     }
 
     private:
+    void handleInput(InputState inputs);
     void internalStartScreen(GameScreen* screen);
 };
 
@@ -0,0 +1,96 @@
+#include <Arduino.h>
+#include "glyph_strip.h"
+
+static const int16_t sScreenWidth = 240;
+
+GlyphStrip::~GlyphStrip() {
+    free(mStrip);
+}
+
+bool GlyphStrip::begin() {
+    if (!mStrip) {
+        mStrip = (uint16_t*)malloc(GLYPH_STRIP_WIDTH * GLYPH_STRIP_HEIGHT * sizeof(uint16_t));
+    }
+    return mStrip != nullptr;
+}
+
+const uint16_t* GlyphStrip::composeString(const GFXfont* font, const String& text,
+    int16_t x, int16_t y, int16_t top, int16_t bottom, uint16_t fg, uint16_t bg,
+    int16_t& outX, int16_t& outY, int16_t& outW, int16_t& outH)
+{
+    if (!mStrip || !font) {
+        return nullptr;
+    }
+
+    // find the box covering every glyph
+    int16_t left = INT16_MAX, right = INT16_MIN;
+    int16_t boxTop = INT16_MAX, boxBottom = INT16_MIN;
+    int16_t cursor = x;
+    for (unsigned int i=0; i<text.length(); ++i) {
+        const uint8_t c = (uint8_t)text[i];
+        if (c < font->first || c > font->last) {
+            continue;
+        }
+        const GFXglyph& glyph = font->glyph[c - font->first];
+        if (glyph.width > 0 && glyph.height > 0) {
+            left = std::min<int16_t>(left, cursor + glyph.xOffset);
+            right = std::max<int16_t>(right, cursor + glyph.xOffset + glyph.width);
+            boxTop = std::min<int16_t>(boxTop, y + glyph.yOffset);
+            boxBottom = std::max<int16_t>(boxBottom, y + glyph.yOffset + glyph.height);
+        }
+        cursor += glyph.xAdvance;
+    }
+
+    // only the rows the caller owns are sent, so neighbours are left alone
+    left = std::max<int16_t>(left, 0);
+    right = std::min<int16_t>(right, sScreenWidth);
+    top = std::max<int16_t>(top, std::max<int16_t>(boxTop, 0));
+    bottom = std::min<int16_t>(bottom, boxBottom);
+    if (left >= right || top >= bottom ||
+        right - left > GLYPH_STRIP_WIDTH || bottom - top > GLYPH_STRIP_HEIGHT) {
+        return nullptr;
+    }
+
+    const int16_t w = right - left;
+    const int16_t h = bottom - top;
+    for (int32_t i = 0; i < (int32_t)w * h; ++i) {
+        mStrip[i] = bg;
+    }
+
+    // glyph bits are packed MSB first and run on across rows; glyph boxes
+    // may overlap, so only the set bits are written
+    cursor = x;
+    for (unsigned int i=0; i<text.length(); ++i) {
+        const uint8_t c = (uint8_t)text[i];
+        if (c < font->first || c > font->last) {
+            continue;
+        }
+        const GFXglyph& glyph = font->glyph[c - font->first];
+        const uint8_t* bitmap = font->bitmap + glyph.bitmapOffset;
+        const int16_t gx = cursor + glyph.xOffset - left;
+        const int16_t gy = y + glyph.yOffset - top;
+        uint8_t bits = 0;
+        uint16_t bit = 0;
+        for (int16_t row = 0; row < glyph.height; ++row) {
+            uint16_t* dst = mStrip + (int32_t)(gy + row) * w;
+            const bool rowShown = gy + row >= 0 && gy + row < h;
+            for (int16_t col = 0; col < glyph.width; ++col) {
+                if ((bit++ & 7) == 0) {
+                    bits = *bitmap++;
+                }
+                const int16_t dx = gx + col;
+                if ((bits & 0x80) && rowShown && dx >= 0 && dx < w) {
+                    dst[dx] = fg;
+                }
+                bits <<= 1;
+            }
+        }
+        cursor += glyph.xAdvance;
+    }
+
+    outX = left;
+    outY = top;
+    outW = w;
+    outH = h;
+    return mStrip;
+}
@@ -0,0 +1,41 @@
+#ifndef GLYPH_STRIP_H
+#define GLYPH_STRIP_H
+
+#include <Adafruit_GFX.h>
+
+// Largest string that can be composed into one burst; anything bigger is
+// drawn through Adafruit_GFX as before. The strip is malloc'd once in
+// begin() and takes width * height * 2 bytes (22.5 KB at the defaults).
+#ifndef GLYPH_STRIP_WIDTH
+  #define GLYPH_STRIP_WIDTH 240
+#endif
+#ifndef GLYPH_STRIP_HEIGHT
+  #define GLYPH_STRIP_HEIGHT 48
+#endif
+
+// Composes a string of GFXfont glyphs into one RGB565 block, so it can be
+// sent to the panel as a single pixel burst instead of pixel by pixel.
+class GlyphStrip {
+
+public:
+    ~GlyphStrip();
+
+    bool begin();
+    bool isEnabled() const {
+        return mStrip != nullptr;
+    }
+
+    // Lays text out with its baseline origin at (x, y) and expands the
+    // glyph bits straight into the strip, fg where set and bg elsewhere.
+    // The strip covers the glyphs' box clipped to rows [top, bottom) and
+    // the screen width, and its screen rectangle is reported back.
+    // Returns nullptr when that doesn't fit in the strip.
+    const uint16_t* composeString(const GFXfont* font, const String& text,
+        int16_t x, int16_t y, int16_t top, int16_t bottom, uint16_t fg, uint16_t bg,
+        int16_t& outX, int16_t& outY, int16_t& outW, int16_t& outH);
+
+private:
+    uint16_t* mStrip = nullptr;
+};
+
+#endif // GLYPH_STRIP_H
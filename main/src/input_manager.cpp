@@ -0,0 +1,155 @@
+#include "input_manager.h"
+
+void InputManager::setup(int upPin, int downPin, int selectPin, int debounceMs) {
+    mDebounceUs = std::max(debounceMs, 1) * 1000;
+
+    mButton[Button::Up].mPin = upPin;
+    mButton[Button::Down].mPin = downPin;
+    mButton[Button::Select].mPin = selectPin;
+
+    const uint32_t now = micros();
+    for(size_t i=0; i<mButton.size(); ++i) {
+        ButtonState& button = mButton[i];
+        button.mManager = this;
+        button.mIndex = i;
+        button.mRepeats = (i == Button::Up || i == Button::Down);
+        pinMode(button.mPin, INPUT_PULLUP);
+        button.mDebounce.reset(digitalRead(button.mPin), now, mDebounceUs);
+        // one held down at boot doesn't count until it is let go
+        button.mPressUs = button.mDebounce.mChangedUs;
+        button.mHeldOff = (button.mDebounce.mLevel == LOW);
+        attachInterruptArg(digitalPinToInterrupt(button.mPin), &edge_isr, &button, CHANGE);
+    }
+}
+
+void IRAM_ATTR InputManager::edge_isr(void* arg) {
+    ButtonState* button = (ButtonState*)arg;
+    InputManager* manager = button->mManager;
+    const InputEdge edge = { (uint32_t)micros(), button->mIndex, (uint8_t)digitalRead(button->mPin) };
+    if (!manager->mEdges.push(edge)) {
+        manager->mLostEdges.store(true, std::memory_order_relaxed);
+    }
+    if (manager->mWake) {
+        manager->mWake(manager->mWakeArg);
+    }
+}
+
+void InputManager::clear() {
+    update();
+    for(size_t i=0; i<mButton.size(); ++i) {
+        ButtonState& button = mButton[i];
+        button.mDebounce.mPresses = 0;
+        button.mLongPressed = false;
+        button.mHeldOff = (button.mDebounce.mLevel == LOW);
+    }
+}
+
+void InputManager::update() {
+    InputEdge edge;
+    while (mEdges.pop(edge)) {
+        mButton[edge.mButton].mDebounce.edge(edge.mLevel, edge.mTimeUs, mDebounceUs);
+    }
+
+    const uint32_t now = micros();
+    if (mLostEdges.exchange(false, std::memory_order_relaxed)) {
+        // the queue filled up, so go by where the pins are now
+        for(size_t i=0; i<mButton.size(); ++i) {
+            mButton[i].mDebounce.edge(digitalRead(mButton[i].mPin), now, mDebounceUs);
+        }
+    }
+    for(size_t i=0; i<mButton.size(); ++i) {
+        mButton[i].mDebounce.settle(now, mDebounceUs);
+        updateHeld(mButton[i], now);
+    }
+}
+
+void InputManager::updateHeld(ButtonState& button, uint32_t nowUs) {
+    const ButtonDebounce& debounce = button.mDebounce;
+    if (debounce.mLevel != LOW) {
+        button.mHeldOff = false;
+        return;
+    }
+    if (debounce.mChangedUs != button.mPressUs) {
+        // a new press, which update() may not have seen let go of the last
+        button.mPressUs = debounce.mChangedUs;
+        button.mRepeatsTaken = 0;
+        button.mLongPressTaken = false;
+        button.mHeldOff = false;
+    }
+    if (button.mHeldOff) {
+        return;
+    }
+
+    // however late this runs, the repeats it missed are all added, so
+    // they are taken as one run rather than spread over the next passes
+    const uint32_t held = nowUs - button.mPressUs;
+    if (button.mRepeats) {
+        const uint32_t due = mRepeat.repeatsAfter(held);
+        if (due > button.mRepeatsTaken) {
+            const uint32_t presses = button.mDebounce.mPresses + due - button.mRepeatsTaken;
+            button.mDebounce.mPresses = std::min<uint32_t>(presses, 255);
+            button.mRepeatsTaken = due;
+        }
+    }
+    if (!button.mLongPressTaken && held >= mRepeat.mLongPressUs) {
+        button.mLongPressTaken = true;
+        button.mLongPressed = true;
+    }
+}
+
+int32_t InputManager::nextUpdateIn() const {
+    const uint32_t now = micros();
+    int32_t next = -1;
+    auto dueAt = [&](uint32_t timeUs) {
+        const int32_t left = (int32_t)(timeUs - now);
+        const int32_t ms = left > 0 ? (left + 999) / 1000 : 0;
+        next = next < 0 ? ms : std::min(next, ms);
+    };
+    for(size_t i=0; i<mButton.size(); ++i) {
+        const ButtonState& button = mButton[i];
+        const ButtonDebounce& debounce = button.mDebounce;
+        if (debounce.isSettling()) {
+            dueAt(debounce.mChangedUs + mDebounceUs);
+        }
+        if (debounce.mLevel == LOW && !button.mHeldOff) {
+            const uint32_t held = now - button.mPressUs;
+            if (button.mRepeats) {
+                dueAt(button.mPressUs + mRepeat.nextRepeatAt(held));
+            }
+            if (!button.mLongPressTaken) {
+                dueAt(button.mPressUs + mRepeat.mLongPressUs);
+            }
+        }
+    }
+    return next;
+}
+
+bool InputManager::hasPresses() const {
+    for(size_t i=0; i<mButton.size(); ++i) {
+        if (mButton[i].mDebounce.mPresses > 0 || mButton[i].mLongPressed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+InputState InputManager::ReadInputState() {
+    InputState input;
+    input.state= 0;
+    input.longPressed= 0;
+    for(size_t i=0; i<mButton.size(); ++i) {
+        ButtonState& button = mButton[i];
+        const uint8_t presses = button.mDebounce.mPresses;
+        input.count[i] = button.mRepeats ? presses : std::min<uint8_t>(presses, 1);
+        if (input.count[i] > 0) {
+            input.state |= Pressed[i];
+            button.mDebounce.mPresses -= input.count[i]; // consume the presses
+        }
+        if (button.mLongPressed) {
+            input.longPressed |= Pressed[i];
+            button.mLongPressed = false;
+        }
+    }
+
+    return input;
+}
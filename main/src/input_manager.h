@@ -1,8 +1,10 @@
 #ifndef INPUT_MANAGER_H
 #define INPUT_MANAGER_H
 
+#include <Arduino.h>
 #include <array>
-#include <vector>
+#include <atomic>
+#include "spsc_ring.h"
 
 enum Button {
     Up,
@@ -13,96 +15,210 @@ enum Button {
 
 const static std::array<int,3> Pressed= {1, 1<<1, 1<<2};
 
+// how long a button is held before it repeats, and how often it does
+#ifndef INPUT_REPEAT_DELAY_MS
+  #define INPUT_REPEAT_DELAY_MS 400
+#endif
+#ifndef INPUT_REPEAT_MS
+  #define INPUT_REPEAT_MS 150
+#endif
+// held this long, it repeats faster
+#ifndef INPUT_REPEAT_FAST_AFTER_MS
+  #define INPUT_REPEAT_FAST_AFTER_MS 1500
+#endif
+#ifndef INPUT_REPEAT_FAST_MS
+  #define INPUT_REPEAT_FAST_MS 50
+#endif
+// held this long, it is reported once as a long press
+#ifndef INPUT_LONG_PRESS_MS
+  #define INPUT_LONG_PRESS_MS 800
+#endif
+
+// a button pin changing, as the GPIO interrupt saw it
+struct InputEdge {
+    uint32_t mTimeUs;
+    uint8_t mButton;
+    uint8_t mLevel;
+};
+
+// Debounces one button from its edges. A change is taken on the first
+// edge, so a press counts with no delay, and the pin is then given the
+// debounce time to stop bouncing before another change can count. If it
+// settles at a different level than the one taken, that is taken once the
+// debounce time is up. Only works on the times it is given, so it can be
+// run over a made up trace of edges.
+struct ButtonDebounce {
+    int mLevel = HIGH;         // debounced, LOW is pressed
+    int mRawLevel = HIGH;      // as of the last edge
+    uint32_t mChangedUs = 0;   // when mLevel last changed
+    uint8_t mPresses = 0;      // not read yet
+
+    void reset(int level, uint32_t nowUs, uint32_t debounceUs) {
+        mLevel = level;
+        mRawLevel = level;
+        mChangedUs = nowUs - debounceUs;
+        mPresses = 0;
+    }
+
+    // an edge at timeUs, edges have to come in time order
+    void edge(int level, uint32_t timeUs, uint32_t debounceUs) {
+        settle(timeUs, debounceUs);
+        mRawLevel = level;
+        if (level != mLevel && timeUs - mChangedUs >= debounceUs) {
+            take(level, timeUs);
+        }
+    }
+
+    // takes the level the pin settled at, if the debounce time is up by nowUs
+    void settle(uint32_t nowUs, uint32_t debounceUs) {
+        if (mRawLevel != mLevel && nowUs - mChangedUs >= debounceUs) {
+            take(mRawLevel, mChangedUs + debounceUs);
+        }
+    }
+
+    // true until a change that came during the debounce time is taken
+    bool isSettling() const {
+        return mRawLevel != mLevel;
+    }
+
+    void take(int level, uint32_t timeUs) {
+        mLevel = level;
+        mChangedUs = timeUs;
+        if (level == LOW && mPresses < 255) {
+            ++mPresses;
+        }
+    }
+};
+
+// When a held button repeats, from how long it has been held. Repeats
+// start after mDelayUs, every mIntervalUs, and every mFastIntervalUs once
+// it has been held mFastAfterUs.
+struct KeyRepeat {
+    uint32_t mDelayUs = INPUT_REPEAT_DELAY_MS * 1000;
+    uint32_t mIntervalUs = INPUT_REPEAT_MS * 1000;
+    uint32_t mFastAfterUs = INPUT_REPEAT_FAST_AFTER_MS * 1000;
+    uint32_t mFastIntervalUs = INPUT_REPEAT_FAST_MS * 1000;
+    uint32_t mLongPressUs = INPUT_LONG_PRESS_MS * 1000;
+
+    // repeats due by the time it has been held heldUs
+    uint32_t repeatsAfter(uint32_t heldUs) const {
+        if (heldUs < mDelayUs) {
+            return 0;
+        }
+        const uint32_t fastAfter = std::max(mFastAfterUs, mDelayUs);
+        uint32_t repeats = (std::min(heldUs, fastAfter) - mDelayUs) / mIntervalUs + 1;
+        if (heldUs > fastAfter) {
+            repeats += (heldUs - fastAfter) / mFastIntervalUs;
+        }
+        return repeats;
+    }
+
+    // how long it has to be held for the next repeat after heldUs
+    uint32_t nextRepeatAt(uint32_t heldUs) const {
+        if (heldUs < mDelayUs) {
+            return mDelayUs;
+        }
+        const uint32_t fastAfter = std::max(mFastAfterUs, mDelayUs);
+        if (heldUs < fastAfter) {
+            const uint32_t next = mDelayUs + ((heldUs - mDelayUs) / mIntervalUs + 1) * mIntervalUs;
+            if (next <= fastAfter) {
+                return next;
+            }
+        }
+        return fastAfter + ((heldUs - std::min(heldUs, fastAfter)) / mFastIntervalUs + 1) * mFastIntervalUs;
+    }
+};
+
+struct InputManager;
+
 struct ButtonState {
     int mPin;
-    int mLastReading;
-    int mNewReadingCounter;
-    bool mPressDetected;
+    ButtonDebounce mDebounce;
+
+    // repeats and the long press of the press that is held, reset when
+    // mDebounce takes a new press
+    bool mRepeats = false;        // if this button repeats at all
+    bool mHeldOff = false;        // clear() came while it was held
+    bool mLongPressed = false;    // not read yet
+    bool mLongPressTaken = false;
+    uint32_t mPressUs = 0;
+    uint32_t mRepeatsTaken = 0;
+
+    // for the interrupt, which is given the button
+    InputManager* mManager;
+    uint8_t mIndex;
 };
 
 struct InputState {
     int state;
+    int longPressed;
+    // presses and repeats of each button, repeating buttons can have more
+    // than one
+    std::array<uint8_t, Button::COUNT> count;
+
     bool isPressed(Button button) {
-        return (state & Pressed[button]) != 0;  
+        return (state & Pressed[button]) != 0;
+    }
+    bool isLongPressed(Button button) {
+        return (longPressed & Pressed[button]) != 0;
+    }
+    int getCount(Button button) {
+        return count[button];
     }
     bool isAnyPressed() {
-        return (state != 0);  
+        return (state != 0);
     }
 };
 
+// Buttons are read from GPIO interrupts, which queue every edge with its
+// time, so a press is never missed however long the main loop takes to
+// get to it, and debounced from those times in update().
 struct InputManager {
     std::array<ButtonState, Button::COUNT> mButton;
-    int mCountRequired;
-
-    void setup(int upPin, int downPin, int selectPin, int countRequired) {
-        mCountRequired = std::max(countRequired, 1);
-        mCountRequired = std::min(countRequired, 254);
-
-        mButton[Button::Up].mPin = upPin;  
-        mButton[Button::Down].mPin = downPin;
-        mButton[Button::Select].mPin = selectPin;  
+    uint32_t mDebounceUs;
+    KeyRepeat mRepeat;
 
-        mButton[Button::Up].mLastReading = HIGH;  
-        mButton[Button::Down].mLastReading = HIGH;
-        mButton[Button::Select].mLastReading = HIGH;  
+    // up and down repeat while held
+    void setup(int upPin, int downPin, int selectPin, int debounceMs);
 
-        mButton[Button::Up].mNewReadingCounter = 0;  
-        mButton[Button::Down].mNewReadingCounter = 0;
-        mButton[Button::Select].mNewReadingCounter = 0;  
-
-        mButton[Button::Up].mPressDetected = false;  
-        mButton[Button::Down].mPressDetected = false;
-        mButton[Button::Select].mPressDetected = false;  
-
-        for(int i=0; i<mButton.size(); ++i) {
-            pinMode(mButton[i].mPin, INPUT_PULLUP);         
-        }
-        for(int i=0; i<mButton.size(); ++i) {
-            mButton[i].mLastReading = digitalRead(mButton[i].mPin);     
-        }
-    };
-
-
-    void clear() {
-        for(int i=0; i<mButton.size(); ++i) {
-            mButton[i].mNewReadingCounter = 0; 
-            mButton[i].mPressDetected = false;          
-        }
-    };
-
-    void update() {
-         for(int i=0; i<mButton.size(); ++i) {
-            ButtonState& button = mButton[i];
-            int Reading = digitalRead(button.mPin); 
-            if (Reading == button.mLastReading) {
-                button.mNewReadingCounter = 0;  
-            }
-            else {
-                if (button.mNewReadingCounter < 255) {
-                    ++button.mNewReadingCounter;  
-                } 
-                if (button.mNewReadingCounter > mCountRequired) {
-                    button.mLastReading = Reading; 
-                    button.mNewReadingCounter = 0;  
-                    button.mPressDetected = (Reading == LOW); 
-                }
-            }    
-        }       
+    void setRepeats(Button button, bool repeats) {
+        mButton[button].mRepeats = repeats;
     }
 
-    InputState ReadInputState() {
-        InputState input;
-        input.state= 0;
-        for(int i=0; i<mButton.size(); ++i) {
-            if (mButton[i].mPressDetected) {
-                input.state |= Pressed[i];
-                mButton[i].mPressDetected = false; // consume the press
-            }
-        }  
-
-        return input;  
+    // called from the GPIO interrupt after an edge is queued, so it has to
+    // be in IRAM too
+    void setWake(void (*wake)(void*), void* arg) {
+        mWake = wake;
+        mWakeArg = arg;
     }
+
+    // drops every press that hasn't been read yet, and a button that is
+    // held doesn't repeat until it is let go
+    void clear();
+
+    // takes the queued edges, and the repeats that are due
+    void update();
+
+    // ms until update() has to run again to take a change that is still
+    // settling, or a repeat or long press, -1 if nothing is due
+    int32_t nextUpdateIn() const;
+    // presses that ReadInputState() hasn't returned yet
+    bool hasPresses() const;
+
+    // every press and repeat waiting of a repeating button, so a run of
+    // them is handled in one go, and one press of any other button, any
+    // more of which are returned by the next calls
+    InputState ReadInputState();
+
+private:
+    static void IRAM_ATTR edge_isr(void* arg);
+    void updateHeld(ButtonState& button, uint32_t nowUs);
+
+    // the interrupts are the only producer, they can't nest on one core
+    SpscRing<InputEdge, 32> mEdges;
+    std::atomic<bool> mLostEdges{false};
+    void (*mWake)(void*) = nullptr;
+    void* mWakeArg = nullptr;
 };
 
 #endif
-
@@ -1,4 +1,9 @@
+#ifndef SCREEN_LAYOUT_H
+#define SCREEN_LAYOUT_H
+
 #include <Arduino.h>
+#include <vector>
+#include "tile_bitmap.h"
 
 struct TextLine {
     TextLine(){};
@@ -29,7 +34,7 @@ struct TextLine {
 struct ScreenLayout {
     
     String mTitle = "";
-    const uint16_t* mBitmap = nullptr; 
+    const TileBitmap* mBitmap = nullptr; 
     std::vector<TextLine> mTextLines;
     std::vector<TextLine> mOptions;
     int mSelection = 0;
@@ -59,9 +64,11 @@ struct ScreenLayout {
     }
 
     ScreenLayout() {};
+    // declared, as operator= is, so copies aren't deprecated
+    ScreenLayout(const ScreenLayout& rha) = default;
 
     ScreenLayout( const String& title,
-        const uint16_t* bitmap, 
+        const TileBitmap* bitmap, 
         const std::vector<TextLine>& textLines,
         const std::vector<TextLine>& options,
         int selection = 0) 
@@ -89,3 +96,5 @@ struct ScreenLayout {
     }  
     
 };
+
+#endif // SCREEN_LAYOUT_H
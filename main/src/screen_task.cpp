@@ -0,0 +1,64 @@
+#include "screen_task.h"
+
+alignas(__STDCPP_DEFAULT_NEW_ALIGNMENT__) static uint8_t sFrames[SCREEN_TASK_FRAMES][SCREEN_TASK_FRAME_SIZE];
+static bool sFrameUsed[SCREEN_TASK_FRAMES] = {};
+static size_t sLargestFrame = 0;
+
+void* ScreenTask::promise_type::operator new(size_t size) {
+    sLargestFrame = std::max(sLargestFrame, size);
+    if (size <= SCREEN_TASK_FRAME_SIZE) {
+        for (int i = 0; i < SCREEN_TASK_FRAMES; ++i) {
+            if (!sFrameUsed[i]) {
+                sFrameUsed[i] = true;
+                return sFrames[i];
+            }
+        }
+    }
+
+    // never the heap, the pool is sized for every task at build time
+    Serial.print(size <= SCREEN_TASK_FRAME_SIZE ? F("Screen task frames all used, ") : F("Screen task frame too big, "));
+    Serial.print((int)size);
+    Serial.print(F(" bytes, pool has "));
+    Serial.print(SCREEN_TASK_FRAMES);
+    Serial.print(F(" of "));
+    Serial.println(SCREEN_TASK_FRAME_SIZE);
+    Serial.flush();
+    abort();
+}
+
+void ScreenTask::promise_type::operator delete(void* frame) noexcept {
+    for (int i = 0; i < SCREEN_TASK_FRAMES; ++i) {
+        if (frame == sFrames[i]) {
+            sFrameUsed[i] = false;
+        }
+    }
+}
+
+void ScreenTask::resume(int result) {
+    if (isDone()) {
+        return;
+    }
+    promise_type& promise = mHandle.promise();
+    promise.mWait = ScreenWait::None;
+    promise.mResult = result;
+    mHandle.resume();
+}
+
+void ScreenTask::destroy() {
+    if (mHandle) {
+        mHandle.destroy();
+        mHandle = nullptr;
+    }
+}
+
+int ScreenTask::getFramesInUse() {
+    int used = 0;
+    for (int i = 0; i < SCREEN_TASK_FRAMES; ++i) {
+        used += sFrameUsed[i] ? 1 : 0;
+    }
+    return used;
+}
+
+size_t ScreenTask::getLargestFrame() {
+    return sLargestFrame;
+}
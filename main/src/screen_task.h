@@ -0,0 +1,136 @@
+#ifndef SCREEN_TASK_H
+#define SCREEN_TASK_H
+
+#include <Arduino.h>
+#include <coroutine>
+
+// Coroutine frames come from a fixed pool, never the heap. Each TaskScreen
+// has at most one task, so a frame for each of them is enough however many
+// are left waiting; game_screens.cpp checks the count when it builds, and
+// checkScreenTaskFrames() checks every frame's size at boot, as the
+// compiler for the board lays it out. Asking for a frame the pool can't
+// give aborts, printing its size.
+#ifndef SCREEN_TASK_FRAMES
+  #define SCREEN_TASK_FRAMES 10
+#endif
+#ifndef SCREEN_TASK_FRAME_SIZE
+  #define SCREEN_TASK_FRAME_SIZE 640
+#endif
+
+// what a task is suspended on
+enum class ScreenWait : uint8_t {
+    None,       // running, finished, or never started
+    Shown,      // the layout it set to be all on screen
+    Time,       // millis() to reach the wake time
+    Selection,  // Select, or the wake time if it has one
+    Sound,      // a sound to be heard out
+};
+
+// A sequence of screens written as a C++20 coroutine, which co_awaits
+// whatever it needs to go on. It doesn't run on its own: whoever started
+// it checks getWait() and calls resume() once that has happened, so a
+// task costs nothing while it waits and the main loop can sleep until the
+// time it asked for.
+class ScreenTask {
+
+public:
+    struct promise_type {
+        ScreenWait mWait = ScreenWait::None;
+        uint32_t mWakeAt = 0;
+        bool mHasTimeout = false;
+        uint32_t mSound = 0;
+        int mResult = -1;
+
+        static void* operator new(size_t size);
+        static void operator delete(void* frame) noexcept;
+
+        ScreenTask get_return_object() noexcept {
+            return ScreenTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        // runs from the first resume()
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {
+            abort();
+        }
+    };
+
+    // what co_await takes, a wait that has already happened doesn't
+    // suspend at all. Gives the option value for Selection, -1 otherwise.
+    struct Await {
+        ScreenWait mWait = ScreenWait::None;
+        uint32_t mWakeAt = 0;
+        bool mHasTimeout = false;
+        uint32_t mSound = 0;
+        int mResult = -1;
+        promise_type* mPromise = nullptr;
+
+        bool await_ready() const noexcept {
+            return mWait == ScreenWait::None;
+        }
+        void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+            mPromise = &handle.promise();
+            mPromise->mWait = mWait;
+            mPromise->mWakeAt = mWakeAt;
+            mPromise->mHasTimeout = mHasTimeout;
+            mPromise->mSound = mSound;
+            mPromise->mResult = -1;
+        }
+        int await_resume() const noexcept {
+            return mPromise ? mPromise->mResult : mResult;
+        }
+    };
+
+    ScreenTask() = default;
+    ScreenTask(ScreenTask&& other) noexcept : mHandle(other.mHandle) {
+        other.mHandle = nullptr;
+    }
+    ScreenTask& operator=(ScreenTask&& other) noexcept {
+        if (this != &other) {
+            destroy();
+            mHandle = other.mHandle;
+            other.mHandle = nullptr;
+        }
+        return *this;
+    }
+    ~ScreenTask() {
+        destroy();
+    }
+
+    bool isDone() const {
+        return !mHandle || mHandle.done();
+    }
+    ScreenWait getWait() const {
+        return isDone() ? ScreenWait::None : mHandle.promise().mWait;
+    }
+    uint32_t getWakeAt() const {
+        return mHandle.promise().mWakeAt;
+    }
+    bool hasTimeout() const {
+        return mHandle.promise().mHasTimeout;
+    }
+    uint32_t getSound() const {
+        return mHandle.promise().mSound;
+    }
+
+    // runs the task to its next co_await, result is what the one it was
+    // waiting on gives back
+    void resume(int result = -1);
+
+    // pool frames taken now, and the most one task has asked for
+    static int getFramesInUse();
+    static size_t getLargestFrame();
+
+private:
+    explicit ScreenTask(std::coroutine_handle<promise_type> handle) : mHandle(handle) {}
+    void destroy();
+
+    std::coroutine_handle<promise_type> mHandle;
+};
+
+#endif // SCREEN_TASK_H
@@ -0,0 +1,110 @@
+#include <string.h>
+#include <algorithm>
+#include "sound_file.h"
+
+static const int16_t AdpcmSteps[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767
+};
+
+static const int8_t AdpcmIndexSteps[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+SoundDecoder::SoundDecoder(const SoundFile& sound) {
+    mData = sound.data;
+    mSize = sound.size;
+    mCodec = sound.codec;
+    mRuns = sound.silence;
+    mRunCount = sound.silenceCount;
+}
+
+void SoundDecoder::advance(uint32_t count) {
+    mPosition += count;
+    if (mRun < mRunCount && mPosition >= mRuns[mRun].start + mRuns[mRun].length) {
+        ++mRun;
+    }
+}
+
+uint32_t SoundDecoder::decode(uint8_t* dst, uint32_t count) {
+    count = std::min(count, getRemaining());
+    uint32_t done = 0;
+    while (done < count) {
+        const uint32_t silent = std::min(count - done, getSilence());
+        if (silent > 0) {
+            memset(dst + done, 0, silent);
+            advance(silent);
+            done += silent;
+        }
+        else {
+            done += decodeAudible(dst + done, std::min(count - done, getAudible()));
+        }
+    }
+    return count;
+}
+
+uint32_t SoundDecoder::decodeAudible(uint8_t* dst, uint32_t count) {
+    if (mCodec == SoundCodec::Pcm8) {
+        memcpy(dst, mData + mDataPosition, count);
+        mDataPosition += count;
+        advance(count);
+        return count;
+    }
+
+    int32_t predictor = mPredictor;
+    int index = mStepIndex;
+    uint32_t position = mDataPosition;
+    for (uint32_t i = 0; i < count; ++i) {
+        // two samples a byte, low nibble first
+        const uint8_t code = (mData[position >> 1] >> ((position & 1) << 2)) & 0x0F;
+        ++position;
+
+        const int32_t step = AdpcmSteps[index];
+        int32_t diff = step >> 3;
+        if (code & 4) {
+            diff += step;
+        }
+        if (code & 2) {
+            diff += step >> 1;
+        }
+        if (code & 1) {
+            diff += step >> 2;
+        }
+        predictor += (code & 8) ? -diff : diff;
+        predictor = std::max<int32_t>(-32768, std::min<int32_t>(32767, predictor));
+
+        index += AdpcmIndexSteps[code & 7];
+        index = std::max(0, std::min(88, index));
+
+        dst[i] = (uint8_t)((predictor + 32768) >> 8);
+    }
+    mPredictor = predictor;
+    mStepIndex = index;
+    mDataPosition = position;
+    advance(count);
+    return count;
+}
+
+void SoundDecoder::skip(uint32_t count) {
+    count = std::min(count, getRemaining());
+    while (count > 0) {
+        uint32_t n = std::min(count, getSilence());
+        if (n > 0) {
+            advance(n);
+        }
+        else if (mCodec == SoundCodec::Pcm8) {
+            n = std::min(count, getAudible());
+            mDataPosition += n;
+            advance(n);
+        }
+        else {
+            // ADPCM has to run through the skipped samples to keep its state
+            uint8_t scratch[32];
+            n = decodeAudible(scratch, std::min<uint32_t>(std::min(count, getAudible()), sizeof(scratch)));
+        }
+        count -= n;
+    }
+}
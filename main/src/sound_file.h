@@ -0,0 +1,87 @@
+#ifndef SOUND_FILE_H
+#define SOUND_FILE_H
+
+#include <stdint.h>
+
+// the rate the sounds were made for, a sample every 126us
+#define SOUND_DEFAULT_RATE 7936
+
+enum class SoundCodec : uint8_t {
+    Pcm8,      // one unsigned sample a byte
+    ImaAdpcm,  // 4 bit IMA-ADPCM, see tools/sound_codec.py for the format
+};
+
+// a stretch of silence (zero samples) that isn't stored in the data
+struct SoundRun
+{
+  uint32_t start;   // first silent sample
+  uint32_t length;
+};
+
+// A sound of size 8 bit unsigned samples at rate Hz. The data
+// holds only the samples outside the silence runs, which are in order
+// and don't overlap.
+struct SoundFile
+{
+  uint32_t size;
+  const uint8_t * data;
+  SoundCodec codec = SoundCodec::Pcm8;
+  uint32_t rate = SOUND_DEFAULT_RATE;
+  const SoundRun* silence = nullptr;
+  uint32_t silenceCount = 0;
+};
+
+// Streams the samples of a SoundFile out a block at a time, carrying the
+// codec state between blocks. Silence runs come out as zeros, or can be
+// stepped over with getSilence() and skip() without touching the data.
+class SoundDecoder {
+public:
+    SoundDecoder() {}
+    explicit SoundDecoder(const SoundFile& sound);
+
+    // writes up to count samples to dst, returns how many were written
+    uint32_t decode(uint8_t* dst, uint32_t count);
+
+    uint32_t getRemaining() const {
+        return mSize - mPosition;
+    }
+
+    // silent samples from here on, 0 if the next sample is stored
+    uint32_t getSilence() const {
+        if (mRun < mRunCount && mRuns[mRun].start <= mPosition) {
+            return mRuns[mRun].start + mRuns[mRun].length - mPosition;
+        }
+        return 0;
+    }
+    // stored samples from here on, up to the next silence run
+    uint32_t getAudible() const {
+        if (mRun < mRunCount) {
+            return mRuns[mRun].start > mPosition ? mRuns[mRun].start - mPosition : 0;
+        }
+        return getRemaining();
+    }
+
+    // the next getAudible() samples as they are stored, or nullptr if they
+    // need decoding
+    const uint8_t* getRawSamples() const {
+        return mCodec == SoundCodec::Pcm8 ? mData + mDataPosition : nullptr;
+    }
+    void skip(uint32_t count);
+
+private:
+    uint32_t decodeAudible(uint8_t* dst, uint32_t count);
+    void advance(uint32_t count);
+
+    const uint8_t* mData = nullptr;
+    uint32_t mSize = 0;
+    uint32_t mPosition = 0;      // in the sound, silence included
+    uint32_t mDataPosition = 0;  // in the stored samples
+    const SoundRun* mRuns = nullptr;
+    uint32_t mRunCount = 0;
+    uint32_t mRun = 0;           // the next or current silence run
+    SoundCodec mCodec = SoundCodec::Pcm8;
+    int32_t mPredictor = -32768;
+    uint8_t mStepIndex = 0;
+};
+
+#endif // SOUND_FILE_H
@@ -1,20 +1,32 @@
 #include <Arduino.h>
 #include "sound_manager.h"
+#include <algorithm>
 //#include <driver/dac.h>
 
 void playSound(int pinSpk, const SoundFile& sound) {
+   // written out at the sound's own rate, there is no mixer to resample
+   const int64_t period = 1000000 / (sound.rate ? sound.rate : SOUND_SAMPLE_RATE);
    int64_t  lastTime = 0;
-   for (int j = 0; j < sound.size; ++j ) {
-      dacWrite(pinSpk, sound.data[j]);
+   SoundDecoder decoder(sound);
+   uint8_t sample = 0;
+   for (uint32_t j = 0; j < sound.size; ++j ) {
+      // sleep through silence instead of writing it out
+      const uint32_t silence = decoder.getSilence();
+      if (silence > 0) {
+         dacWrite(pinSpk, 0);
+         usleep(silence * period);
+         decoder.skip(silence);
+         j += silence - 1;
+         lastTime = esp_timer_get_time();
+         continue;
+      }
+      decoder.decode(&sample, 1);
+      dacWrite(pinSpk, sample);
       int64_t  currentTime = esp_timer_get_time();
       if (currentTime >= lastTime) {
          int64_t  elapsedTime = currentTime - lastTime;
-         if (elapsedTime < 125) {
-            int64_t waitTime = 125 - elapsedTime;
-			if (j % 1024 == 0) {
-				Serial.println(F("WaitTimeSample: "));
-				Serial.println(waitTime, DEC);
-			}
+         if (elapsedTime < period) {
+            int64_t waitTime = period - elapsedTime;
             usleep(waitTime);
          }
       }
@@ -24,64 +36,291 @@ void playSound(int pinSpk, const SoundFile& sound) {
 
 void SoundManager::setup(int pin) {
     mOutputPin = pin;
-    mMutex = xSemaphoreCreateMutex();
+    mMixer.setOutputRate(SOUND_SAMPLE_RATE);
 
     const esp_timer_create_args_t periodic_timer_args = {
             .callback = &audio_timer_callback,
             /* name is optional, but may help identify the timer when debugging */
             .arg = (void*)this,
+            .dispatch_method = ESP_TIMER_TASK,
             .name = "audioPlayer",
-            
+            .skip_unhandled_events = false,
     };
 
-    esp_timer_handle_t periodic_timer;
     ESP_ERROR_CHECK(esp_timer_create(&periodic_timer_args, &mAudioTimer));
-    
+
+    const esp_timer_create_args_t wake_timer_args = {
+            .callback = &wake_timer_callback,
+            .arg = (void*)this,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "audioWake",
+            .skip_unhandled_events = false,
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&wake_timer_args, &mWakeTimer));
+
+    // the timer stays as a fallback if the DAC can't stream
+    if (SOUND_USE_DAC_DMA && !startDma()) {
+        Serial.println(F("DAC DMA unavailable, playing sounds from a timer"));
+    }
 }
 
-void SoundManager::play(const SoundFile& sound, bool waitForSong) {
-    xSemaphoreTake(mMutex, portMAX_DELAY);
-    mRequest = &sound;
-    mHaltPlayback = false;
-    mWaitForSong = waitForSong;
-    xSemaphoreGive(mMutex);
+bool SoundManager::startDma() {
+#if SOUND_USE_DAC_DMA
+    const dac_continuous_config_t config = {
+        .chan_mask = mOutputPin == DAC2 ? DAC_CHANNEL_MASK_CH1 : DAC_CHANNEL_MASK_CH0,
+        .desc_num = SOUND_DMA_BLOCKS,
+        .buf_size = SOUND_BLOCK_SAMPLES,
+        .freq_hz = SOUND_SAMPLE_RATE,
+        .offset = 0,
+        .clk_src = DAC_DIGI_CLK_SRC_DEFAULT,
+        .chan_mode = DAC_CHANNEL_MODE_SIMUL,
+    };
+    if (dac_continuous_new_channels(&config, &mDac) != ESP_OK) {
+        mDac = nullptr;
+        return false;
+    }
+
+    // above the loop task, so blocks are refilled while the game is busy
+    if (xTaskCreate(&output_task, "audioOutput", 3072, this, 5, &mOutputTask) != pdPASS) {
+        dac_continuous_del_channels(mDac);
+        mDac = nullptr;
+        mOutputTask = nullptr;
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+SoundHandle SoundManager::play(const SoundFile& sound, bool waitForSong, SoundPriority priority) {
+    const SoundHandle handle = nextHandle();
+    mPlaying.push_back(handle);
+    sendCommand(&sound, handle, priority, waitForSong);
+    return handle;
+}
+
+SoundHandle SoundManager::queue(const SoundFile& sound, bool waitForSong, SoundPriority priority) {
+    if (mQueue.empty() && isFinished(mQueueHead)) {
+        mQueueHead = play(sound, waitForSong, priority);
+        return mQueueHead;
+    }
+    const SoundHandle handle = nextHandle();
+    mQueue.push_back({ &sound, handle, priority, waitForSong });
+    return handle;
 }
 
 void SoundManager::stop() {
-    xSemaphoreTake(mMutex, portMAX_DELAY);
-    mRequest = nullptr;
-    mHaltPlayback = true;
-    xSemaphoreGive(mMutex);
+    std::vector<QueuedSound> dropped;
+    dropped.swap(mQueue);
+    sendCommand(nullptr, 0, SoundPriority::Effect, false);
+
+    // the playing sounds end from the audio side, queued ones never started
+    for (const QueuedSound& queued : dropped) {
+        finish(queued.mHandle);
+    }
+}
+
+SoundHandle SoundManager::nextHandle() {
+    if (++mLastHandle == 0) {
+        ++mLastHandle;
+    }
+    return mLastHandle;
+}
+
+void SoundManager::sendCommand(const SoundFile* sound, SoundHandle handle, SoundPriority priority, bool waitForSong) {
+    if (sound == nullptr) {
+        mSentState = 0;
+    }
+    else {
+        mSentState = getState() | STATE_PLAYING | (waitForSong ? STATE_SONG : 0);
+    }
+
+    const SoundCommand command = { sound, ++mSentSequence, handle, priority, waitForSong };
+    if (!mCommands.push(command)) {
+        // the audio side takes every command at once, so this only
+        // happens if it is stalled
+        const int64_t waitStart = esp_timer_get_time();
+        do {
+            wakeOutput();
+            vTaskDelay(1);
+        } while (!mCommands.push(command));
+        mTiming.commandWait((uint32_t)(esp_timer_get_time() - waitStart));
+    }
+    wakeOutput();
+}
+
+bool SoundManager::isFinished(SoundHandle handle) const {
+    if (handle == 0) {
+        return true;
+    }
+    if (std::find(mPlaying.begin(), mPlaying.end(), handle) != mPlaying.end()) {
+        return false;
+    }
+    for (const QueuedSound& queued : mQueue) {
+        if (queued.mHandle == handle) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SoundManager::onFinished(SoundHandle handle, SoundCallback callback, void* context) {
+    if (isFinished(handle)) {
+        callback(context);
+        return;
+    }
+    mWaiters.push_back({ handle, callback, context });
+}
+
+void SoundManager::finish(SoundHandle handle) {
+    auto it = std::find(mPlaying.begin(), mPlaying.end(), handle);
+    if (it != mPlaying.end()) {
+        mPlaying.erase(it);
+    }
+
+    // the next queued sound starts before anyone hears about this one
+    if (handle == mQueueHead && !mQueue.empty()) {
+        const QueuedSound next = mQueue.front();
+        mQueue.erase(mQueue.begin());
+        mQueueHead = next.mHandle;
+        mPlaying.push_back(next.mHandle);
+        sendCommand(next.mSound, next.mHandle, next.mPriority, next.mWaitForSong);
+    }
+
+    // a callback can play or stop sounds, which can change mWaiters, so
+    // take each one out before calling it and start over afterwards
+    size_t i = 0;
+    while (i < mWaiters.size()) {
+        if (mWaiters[i].mHandle != handle) {
+            ++i;
+            continue;
+        }
+        const Waiter waiter = mWaiters[i];
+        mWaiters.erase(mWaiters.begin() + i);
+        waiter.mCallback(waiter.mContext);
+        i = 0;
+    }
+}
+
+void SoundManager::updateEvents() {
+    // read before draining, so every event pushed before an idle state is seen
+    const bool idle = mState.load(std::memory_order_acquire) == (mSentSequence & 0x3FFFFFFF) << 2;
+    const uint32_t lost = mLostEvents.load(std::memory_order_acquire);
+
+    SoundEvent event;
+    while (mEvents.pop(event)) {
+        mEnding.push_back(event);
+    }
+
+    // events went missing, so once all is quiet nothing can still be playing
+    if (lost != mSeenLostEvents && idle) {
+        Serial.println(F("Sound events lost, finishing every sound"));
+        mSeenLostEvents = lost;
+        mEnding.clear();
+        std::vector<SoundHandle> stale;
+        stale.swap(mPlaying);
+        for (SoundHandle handle : stale) {
+            finish(handle);
+        }
+        return;
+    }
+
+    // a sound is finished once its last sample has been played, not when
+    // the audio side is done with it
+    const int64_t now = esp_timer_get_time();
+    size_t i = 0;
+    while (i < mEnding.size()) {
+        if (now < mEnding[i].mEndTime) {
+            ++i;
+            continue;
+        }
+        const SoundHandle handle = mEnding[i].mHandle;
+        mEnding.erase(mEnding.begin() + i);
+        finish(handle);
+    }
+}
+
+int64_t SoundManager::getNextEndTime() const {
+    int64_t next = 0;
+    for (const SoundEvent& event : mEnding) {
+        if (next == 0 || event.mEndTime < next) {
+            next = event.mEndTime;
+        }
+    }
+    return next;
+}
+
+void SoundManager::wakeOutput() {
+    if (mOutputTask) {
+        xTaskNotifyGive(mOutputTask);
+    }
+    else if (!esp_timer_is_active(mAudioTimer)) {
+        startTimer();
+    }
+}
+
+void SoundManager::startTimer() {
+    // play() and the wake timer can race to get here, the loser finds it running
+    const esp_err_t err = esp_timer_start_periodic(mAudioTimer, SOUND_SAMPLE_PERIOD_US);
+    if (err != ESP_ERR_INVALID_STATE) {
+        ESP_ERROR_CHECK(err);
+    }
+}
+
+uint32_t SoundManager::getState() const {
+    const uint32_t state = mState.load(std::memory_order_acquire);
+    if ((state >> 2) != (mSentSequence & 0x3FFFFFFF)) {
+        // the audio side hasn't taken the last command yet
+        return mSentState;
+    }
+    return state & (STATE_PLAYING | STATE_SONG);
 }
 
 bool SoundManager::isPlaying() {
-    xSemaphoreTake(mMutex, portMAX_DELAY);
-    bool playing = !mHaltPlayback && (mPlaying || mRequest != nullptr);
-    xSemaphoreGive(mMutex);
-    return playing;
+    return (getState() & STATE_PLAYING) || !mQueue.empty();
 }
 
 bool SoundManager::isWaitingForSong() {
-    return isPlaying() && mWaitForSong;
+    if (getState() & STATE_SONG) {
+        return true;
+    }
+    for (const QueuedSound& queued : mQueue) {
+        if (queued.mWaitForSong) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void SoundManager::update() {
-    xSemaphoreTake(mMutex, portMAX_DELAY);
-    bool playing = mPlaying;
-    const SoundFile* request = mRequest;
-    xSemaphoreGive(mMutex);
-    
-    if (!playing) {
-        bool timerActive = esp_timer_is_active(mAudioTimer);
-        if (request != nullptr && !timerActive) {
-            // timer needs to start
-            ESP_ERROR_CHECK(esp_timer_start_periodic(mAudioTimer, 126));
-        }
-        else if (mRequest == nullptr && timerActive) {
-            // timer may stop
-            ESP_ERROR_CHECK(esp_timer_stop(mAudioTimer));
-        }
+    // logged from here, printing could block the audio side
+    const bool playing = mState.load(std::memory_order_acquire) & STATE_PLAYING;
+    if (playing != mWasPlaying) {
+        Serial.println(playing ? "Starting playback!" : "Finished playback!");
+        mWasPlaying = playing;
+    }
+    updateEvents();
+
+    if (isUsingDma()) {
+        // the output task starts and stops the DAC itself
+        return;
     }
+
+    // the timer only runs while there is something to play, but not
+    // before the audio side has taken every command
+    if (!isPlaying() && mCommands.empty() && esp_timer_is_active(mAudioTimer)) {
+        ESP_ERROR_CHECK(esp_timer_stop(mAudioTimer));
+    }
+}
+
+void SoundManager::dumpTiming(Print& out) {
+    const AudioTiming timing = mTiming.snapshot();
+    out.println(isUsingDma() ? F("Audio timing (DMA), since last dump:") : F("Audio timing (timer), since last dump:"));
+    timing.since(mDumpedTiming).dump(out);
+    out.println(F("Since power on:"));
+    timing.dump(out);
+    mDumpedTiming = timing;
 }
 
 void SoundManager::audio_timer_callback(void* arg) {
@@ -89,37 +328,168 @@ void SoundManager::audio_timer_callback(void* arg) {
     sm->onTimer();
 }
 
-void SoundManager::onTimer() {
+void SoundManager::takeRequests() {
     // exchange data with the outside world
-    xSemaphoreTake(mMutex, portMAX_DELAY);
-    const SoundFile* request = mRequest;
-    bool halt = mHaltPlayback;
-    mRequest = nullptr;
-    mHaltPlayback = false;
-    mPlaying = !halt && (mRequest != nullptr || mActiveSound != nullptr);
-    xSemaphoreGive(mMutex);
-    
-    if (request) {
-        mActiveSound = request;
-        mPlayPosition = 0;
-        Serial.println("Starting playback!");
-    }
-    else if (halt) {
-        mActiveSound = nullptr;
-        mPlayPosition = 0;
-        Serial.println("Ending playback!");
-    }
-
-    if (mActiveSound) {
-        mPlayPosition++;
-        if (mPlayPosition < mActiveSound->size) {
-            dacWrite(mOutputPin, mActiveSound->data[mPlayPosition]);
+    SoundCommand command;
+    while (mCommands.pop(command)) {
+        if (command.mSound) {
+            mMixer.start(command.mSound, command.mPriority, command.mWaitForSong, command.mHandle);
         }
         else {
+            mMixer.stopAll();
+        }
+        mTakenSequence = command.mSequence;
+    }
+}
+
+void SoundManager::publishState() {
+    const uint32_t bits = (mMixer.isPlaying() ? STATE_PLAYING : 0)
+        | (mMixer.isPlayingSong() ? STATE_SONG : 0);
+    mState.store((mTakenSequence << 2) | bits, std::memory_order_release);
+    if (bits != mPublishedBits) {
+        mPublishedBits = bits;
+        if (mWake) {
+            mWake(mWakeContext);
+        }
+    }
+}
+
+void SoundManager::publishEnds(int64_t blockStart) {
+    // before publishState(), the game side relies on that order
+    bool lost = mMixer.hasLostEnds();
+    for (int i = 0; i < mMixer.getEndCount(); ++i) {
+        const SoundEnd& end = mMixer.getEnd(i);
+        const SoundEvent event = { end.mHandle, blockStart + (int64_t)end.mOffset * SOUND_SAMPLE_PERIOD_US };
+        lost |= !mEvents.push(event);
+    }
+    const bool ended = mMixer.getEndCount() > 0;
+    mMixer.clearEnds();
+    if (lost) {
+        mLostEvents.fetch_add(1, std::memory_order_release);
+    }
+    if ((ended || lost) && mWake) {
+        mWake(mWakeContext);
+    }
+}
+
+void SoundManager::wake_timer_callback(void* arg) {
+    SoundManager* sm = (SoundManager*)arg;
+    if (sm->mParkedAt != 0) {
+        sm->startTimer();
+    }
+}
+
+void SoundManager::onTimer() {
+#if SOUND_TIMING_STATS
+    // ticks only have to keep to the period while something plays
+    const int64_t tickStart = esp_timer_get_time();
+    if (mMixer.isPlaying()) {
+        mTiming.tick(tickStart, mDisplayBusy.load(std::memory_order_relaxed));
+    }
+    else {
+        mTiming.restart();
+    }
+#endif
+
+    // mix a small block at a time, and write it out a sample per tick
+    if (mTimerPosition >= SOUND_TIMER_BLOCK) {
+        const int64_t now = esp_timer_get_time();
+        if (mParkedAt != 0) {
+            // catch up on the silence that went by, before any new sound
+            // starts, whether the wake timer or a command brought us back
+            esp_timer_stop(mWakeTimer);
+            mMixer.skipSilence((uint32_t)((now - mParkedAt) / SOUND_SAMPLE_PERIOD_US));
+            mParkedAt = 0;
+        }
+        takeRequests();
+
+        // every voice is quiet for a while, so stop ticking until one isn't
+        const uint32_t silence = mMixer.getSilence();
+        if (silence >= SOUND_PARK_SAMPLES) {
             dacWrite(mOutputPin, 0);
-            Serial.println("Finished playback!");
-            mActiveSound = nullptr;
-            mPlayPosition = 0;
+            publishEnds(now);
+            publishState();
+            mParkedAt = now;
+            ++mParkCount;
+            mTiming.restart();
+            esp_timer_stop(mAudioTimer);
+            esp_timer_start_once(mWakeTimer, (uint64_t)silence * SOUND_SAMPLE_PERIOD_US);
+            // a play() since takeRequests() found the timer still running
+            // and left it to us, so don't sit out the silence on it
+            if (!mCommands.empty()) {
+                startTimer();
+            }
+            return;
         }
+
+        mMixer.mix(mTimerBlock, SOUND_TIMER_BLOCK);
+#if SOUND_TIMING_STATS
+        mTiming.mixed((uint32_t)(esp_timer_get_time() - now));
+#endif
+        publishEnds(now);
+        publishState();
+        mTimerPosition = 0;
     }
-}
\ No newline at end of file
+    dacWrite(mOutputPin, mTimerBlock[mTimerPosition++]);
+#if SOUND_TIMING_STATS
+    mTiming.tickDone(tickStart, esp_timer_get_time());
+#endif
+}
+
+void SoundManager::output_task(void* arg) {
+    SoundManager* sm = (SoundManager*)arg;
+    sm->runOutputTask();
+}
+
+void SoundManager::runOutputTask() {
+#if SOUND_USE_DAC_DMA
+    static uint8_t block[SOUND_BLOCK_SAMPLES];
+    int silentBlocks = SOUND_DMA_BLOCKS;
+    bool enabled = false;
+    // when the blocks written so far will have played out
+    int64_t queuedUntil = 0;
+
+    while (true) {
+        takeRequests();
+
+        // once the queued blocks have played out to silence, stop the DAC
+        // and sleep until play() wakes us
+        if (!mMixer.isPlaying() && silentBlocks >= SOUND_DMA_BLOCKS) {
+            publishEnds(esp_timer_get_time());
+            publishState();
+            if (enabled) {
+                dac_continuous_disable(mDac);
+                enabled = false;
+            }
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+        if (!enabled) {
+            dac_continuous_enable(mDac);
+            enabled = true;
+            queuedUntil = 0;
+        }
+
+#if SOUND_TIMING_STATS
+        const int64_t mixStart = esp_timer_get_time();
+#endif
+        silentBlocks = mMixer.mix(block, SOUND_BLOCK_SAMPLES) > 0 ? 0 : silentBlocks + 1;
+        const int64_t now = esp_timer_get_time();
+#if SOUND_TIMING_STATS
+        mTiming.mixed((uint32_t)(now - mixStart));
+        if (queuedUntil != 0) {
+            // the DAC has been streaming since it was enabled, so a block
+            // that isn't ready before the last one ends is an underrun
+            mTiming.lead(queuedUntil - now, mDisplayBusy.load(std::memory_order_relaxed));
+        }
+#endif
+        const int64_t blockStart = std::max(now, queuedUntil);
+        queuedUntil = blockStart + SOUND_BLOCK_SAMPLES * SOUND_SAMPLE_PERIOD_US;
+        publishEnds(blockStart);
+        publishState();
+
+        // waits for DMA to free up a block, which paces the whole loop
+        dac_continuous_write(mDac, block, SOUND_BLOCK_SAMPLES, nullptr, -1);
+    }
+#endif
+}
@@ -5,43 +5,211 @@
 #include "esp_timer.h"
 #include "esp_log.h"
 #include "esp_sleep.h"
+#include "esp_idf_version.h"
+#include "soc/soc_caps.h"
 #include "FreeRTOS.h"
-#include "semphr.h"
+#include "task.h"
+#include <atomic>
+#include <vector>
+#include "spsc_ring.h"
+#include "sound_mixer.h"
+#include "audio_timing.h"
 
-struct SoundFile
-{
-  uint32_t size;
-  const uint8_t * data;
-};
+// The DAC is fed 8 bit unsigned samples at this period, sounds made for
+// any other rate are resampled to it as they play
+#ifndef SOUND_SAMPLE_PERIOD_US
+  #define SOUND_SAMPLE_PERIOD_US 126
+#endif
+#define SOUND_SAMPLE_RATE (1000000 / SOUND_SAMPLE_PERIOD_US)
+
+// Stream samples to the DAC with DMA, refilled a block at a time by a
+// task, instead of a timer callback per sample. Needs the continuous DAC
+// driver from ESP-IDF 5; the timer is still used if it can't start.
+#ifndef SOUND_USE_DAC_DMA
+  #if ESP_IDF_VERSION_MAJOR >= 5 && defined(SOC_DAC_SUPPORTED)
+    #define SOUND_USE_DAC_DMA 1
+  #else
+    #define SOUND_USE_DAC_DMA 0
+  #endif
+#endif
+
+// samples per DMA block, and how many blocks are queued ahead. The timer
+// path mixes SOUND_TIMER_BLOCK samples at a time and writes them out one
+// per tick.
+#ifndef SOUND_BLOCK_SAMPLES
+  #define SOUND_BLOCK_SAMPLES 128
+#endif
+#ifndef SOUND_DMA_BLOCKS
+  #define SOUND_DMA_BLOCKS 4
+#endif
+#ifndef SOUND_TIMER_BLOCK
+  #define SOUND_TIMER_BLOCK 32
+#endif
+
+// On the timer path, once every voice is silent for at least this many
+// samples the DAC is left at zero and the timer stops until the first
+// one has something to play again.
+#ifndef SOUND_PARK_SAMPLES
+  #define SOUND_PARK_SAMPLES 256
+#endif
+
+#if SOUND_USE_DAC_DMA
+  #include "driver/dac_continuous.h"
+#endif
 
 // play a sound as a blocking operation
 void playSound(int pinSpk, const SoundFile& sound);
 
-// a sound amanger to play async sounds using a hardware timer
+// identifies one play() of a sound, 0 is never used
+typedef uint32_t SoundHandle;
+
+// called from SoundManager::update() once a sound has been heard out
+typedef void (*SoundCallback)(void* context);
+
+// a play request from the game, or a stop when mSound is nullptr
+struct SoundCommand {
+  const SoundFile* mSound;
+  uint32_t mSequence;
+  SoundHandle mHandle;
+  SoundPriority mPriority;
+  bool mWaitForSong;
+};
+
+// a sound that stopped on the audio side, and when its last sample
+// leaves the DAC (esp_timer time)
+struct SoundEvent {
+  SoundHandle mHandle;
+  int64_t mEndTime;
+};
+
+// a sound amanger to play async sounds using DMA or a hardware timer
 class SoundManager {
 	int mOutputPin;
-	SemaphoreHandle_t mMutex;
 	esp_timer_handle_t mAudioTimer;
+	esp_timer_handle_t mWakeTimer;
+	TaskHandle_t mOutputTask = nullptr;
+#if SOUND_USE_DAC_DMA
+	dac_continuous_handle_t mDac = nullptr;
+#endif
 	
-	// internal, active state
-	const SoundFile* mActiveSound = nullptr;
-	uint32_t mPlayPosition = 0;
-	bool mPlaying = false;
-	
-	// user requested state changes
-	const SoundFile* mRequest = nullptr;
-	bool mHaltPlayback = false;
+	// Commands go from the game to the audio side through a lock-free
+	// ring, and the audio side publishes the sequence number of the last
+	// command it took along with its STATE_ bits, as
+	// (sequence << 2) | bits. Neither side ever waits on the other.
+	static constexpr uint32_t STATE_PLAYING = 1;
+	static constexpr uint32_t STATE_SONG = 1 << 1;
+	SpscRing<SoundCommand, 8> mCommands;
+	std::atomic<uint32_t> mState{0};
+
+	// Sounds that stopped go back the other way. If the ring ever fills,
+	// the lost count goes up and the game side gives up on telling the
+	// handles apart: everything it is waiting on ends once all is quiet.
+	SpscRing<SoundEvent, 32> mEvents;
+	std::atomic<uint32_t> mLostEvents{0};
+
+	// timing of the audio path, and whether the main loop is pushing the
+	// display while it is measured
+	AudioTimingCounters mTiming;
+	std::atomic<bool> mDisplayBusy{false};
+	AudioTiming mDumpedTiming;
+
+	// internal, active state, only touched by the audio side
+	SoundMixer mMixer;
+	uint32_t mTakenSequence = 0;
+	uint8_t mTimerBlock[SOUND_TIMER_BLOCK] = {};
+	uint32_t mTimerPosition = SOUND_TIMER_BLOCK;
+	int64_t mParkedAt = 0;
+	uint32_t mParkCount = 0;
+	uint32_t mPublishedBits = 0;
+
+	// tells the main loop something changed, set before any sound plays
+	SoundCallback mWake = nullptr;
+	void* mWakeContext = nullptr;
+
+	// game side state, what the state will be once the last command is taken
+	uint32_t mSentState = 0;
+	uint32_t mSentSequence = 0;
+	bool mWasPlaying = false;
+
+	// game side completion tracking. mPlaying has the handles sent to the
+	// audio side that haven't been heard out yet, mEnding the ones that
+	// stopped but are still in the DMA buffers.
+	struct Waiter {
+		SoundHandle mHandle;
+		SoundCallback mCallback;
+		void* mContext;
+	};
+	struct QueuedSound {
+		const SoundFile* mSound;
+		SoundHandle mHandle;
+		SoundPriority mPriority;
+		bool mWaitForSong;
+	};
+	SoundHandle mLastHandle = 0;
+	SoundHandle mQueueHead = 0;
+	uint32_t mSeenLostEvents = 0;
+	std::vector<SoundHandle> mPlaying;
+	std::vector<SoundEvent> mEnding;
+	std::vector<Waiter> mWaiters;
+	std::vector<QueuedSound> mQueue;
+
+	bool startDma();
+	SoundHandle nextHandle();
+	void sendCommand(const SoundFile* sound, SoundHandle handle, SoundPriority priority, bool waitForSong);
+	void finish(SoundHandle handle);
+	void updateEvents();
+	uint32_t getState() const;
+	void wakeOutput();
+	void startTimer();
+	void takeRequests();
+	void publishState();
+	void publishEnds(int64_t blockStart);
+	void runOutputTask();
+	static void output_task(void* arg);
 
-	bool mWaitForSong = false;
 public:	
 	void setup(int pin);	
-	void play(const SoundFile& sound, bool waitForSong= true);	
+	SoundHandle play(const SoundFile& sound, bool waitForSong= true, SoundPriority priority= SoundPriority::Effect);	
+	// plays once every sound queued before it has been heard out
+	SoundHandle queue(const SoundFile& sound, bool waitForSong= true, SoundPriority priority= SoundPriority::Effect);
+	// stops everything, including the queue
 	void stop();	
+	// true once the sound has played out, was stopped, or never got a voice
+	bool isFinished(SoundHandle handle) const;
+	// calls back from update() once isFinished(handle), or right away
+	void onFinished(SoundHandle handle, SoundCallback callback, void* context);
+	// called from the audio side whenever a sound stops or playback starts
+	// or ends, so the main loop can sleep until update() has work
+	void setWake(SoundCallback wake, void* context) {
+		mWake = wake;
+		mWakeContext = context;
+	}
+	// when the next stopped sound will have played out (esp_timer time),
+	// 0 if none is waiting on it
+	int64_t getNextEndTime() const;
 	bool isPlaying();
 	bool isWaitingForSong();
+	bool isUsingDma() const {
+		return mOutputTask != nullptr;
+	}
 	void update();
 	void onTimer();
+	// the main loop marks display updates, so audio misses can be blamed
+	void setDisplayBusy(bool busy) {
+		mDisplayBusy.store(busy, std::memory_order_relaxed);
+	}
+	AudioTiming getTiming() const {
+		return mTiming.snapshot();
+	}
+	// prints the timing since the last dump, then since power on
+	void dumpTiming(Print& out);
+
+	// how often the timer path has stopped ticking through silence
+	uint32_t getParkCount() const {
+		return mParkCount;
+	}
 	static void audio_timer_callback(void* arg);	
+	static void wake_timer_callback(void* arg);
 };
 
 #endif
\ No newline at end of file
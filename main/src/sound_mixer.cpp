@@ -0,0 +1,329 @@
+#include <string.h>
+#include <algorithm>
+#include "sound_mixer.h"
+
+// samples summed per pass, bounds the accumulator on the stack
+#define SOUND_MIX_CHUNK 64
+
+// a voice at the output rate, mixed without resampling
+#define SOUND_UNITY_STEP (1 << 16)
+
+bool SoundMixer::start(const SoundFile* sound, SoundPriority priority, bool waitForSong, uint32_t handle) {
+    if (sound == nullptr || sound->size == 0) {
+        addEnd(handle, 0);
+        return false;
+    }
+
+    // a UI sound that is already playing starts over rather than stacking
+    Voice* voice = nullptr;
+    if (priority == SoundPriority::Ui) {
+        for (Voice& v : mVoices) {
+            if (v.mSound == sound) {
+                voice = &v;
+                break;
+            }
+        }
+    }
+
+    // then a free voice, then one that is only fading out
+    for (Voice& v : mVoices) {
+        if (voice == nullptr && v.mSound == nullptr) {
+            voice = &v;
+        }
+    }
+    for (Voice& v : mVoices) {
+        if (voice == nullptr && v.mReleasing) {
+            voice = &v;
+        }
+    }
+
+    // then the oldest voice this sound outranks or equals
+    if (voice == nullptr) {
+        for (Voice& v : mVoices) {
+            if (v.mPriority <= priority && (voice == nullptr || v.mStartOrder < voice->mStartOrder)) {
+                voice = &v;
+            }
+        }
+    }
+    if (voice == nullptr) {
+        addEnd(handle, 0);
+        return false;
+    }
+    if (voice->mSound) {
+        addEnd(voice->mHandle, 0);
+    }
+
+    *voice = Voice();
+    voice->mSound = sound;
+    voice->mDecoder = SoundDecoder(*sound);
+    voice->mPriority = priority;
+    voice->mWaitForSong = waitForSong;
+    voice->mStartOrder = ++mStartCount;
+    voice->mHandle = handle;
+    setTarget(*voice, SOUND_UNITY_GAIN, SOUND_ATTACK_SAMPLES);
+
+    const uint32_t rate = sound->rate ? sound->rate : mOutputRate;
+    voice->mStep = (uint32_t)std::min<uint64_t>(((uint64_t)rate << 16) / mOutputRate,
+        SOUND_MAX_RATE_RATIO * SOUND_UNITY_STEP);
+    if (voice->mStep != SOUND_UNITY_STEP) {
+        // the resampler works between two samples, so start with the first two
+        voice->mLive = voice->mDecoder.decode(&voice->mPrevious, 1) << 1;
+        voice->mLive |= voice->mDecoder.decode(&voice->mNext, 1);
+    }
+    return true;
+}
+
+void SoundMixer::stopAll() {
+    for (Voice& v : mVoices) {
+        if (v.mSound && !v.mReleasing) {
+            v.mReleasing = true;
+            setTarget(v, 0, SOUND_RELEASE_SAMPLES);
+            if (v.mLevel == 0) {
+                addEnd(v.mHandle, 0);
+                v = Voice();
+            }
+        }
+    }
+}
+
+void SoundMixer::addEnd(uint32_t handle, uint32_t offset) {
+    if (handle == 0) {
+        return;
+    }
+    if (mEndCount >= (int)mEnds.size()) {
+        mLostEnds = true;
+        return;
+    }
+    mEnds[mEndCount++] = { handle, offset };
+}
+
+void SoundMixer::setTarget(Voice& voice, uint16_t gain, uint32_t samples) {
+    voice.mTarget = (int32_t)gain << 8;
+    if (samples == 0) {
+        voice.mLevel = voice.mTarget;
+        voice.mRamp = 0;
+        return;
+    }
+    voice.mRamp = (voice.mTarget - voice.mLevel) / (int32_t)samples;
+    if (voice.mRamp == 0) {
+        voice.mRamp = voice.mTarget > voice.mLevel ? 1 : -1;
+    }
+}
+
+void SoundMixer::advanceLevel(Voice& voice, uint32_t count) {
+    if (voice.mLevel == voice.mTarget) {
+        return;
+    }
+    const int64_t level = voice.mLevel + (int64_t)voice.mRamp * count;
+    const bool passed = voice.mRamp > 0 ? level >= voice.mTarget : level <= voice.mTarget;
+    voice.mLevel = passed ? voice.mTarget : (int32_t)level;
+}
+
+bool SoundMixer::isPlaying() const {
+    for (const Voice& v : mVoices) {
+        if (v.mSound) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SoundMixer::isPlayingSong() const {
+    for (const Voice& v : mVoices) {
+        if (v.mSound && v.mWaitForSong && !v.mReleasing) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t SoundMixer::getSilence() const {
+    uint32_t silence = 0;
+    bool any = false;
+    for (const Voice& v : mVoices) {
+        if (v.mSound) {
+            // only voices at the output rate count silence in output samples
+            if (v.mReleasing || v.mStep != SOUND_UNITY_STEP) {
+                return 0;
+            }
+            silence = any ? std::min(silence, v.mDecoder.getSilence()) : v.mDecoder.getSilence();
+            any = true;
+        }
+    }
+    return silence;
+}
+
+void SoundMixer::skipSilence(uint32_t count) {
+    for (Voice& v : mVoices) {
+        if (v.mSound) {
+            const uint32_t n = std::min(count, v.mDecoder.getSilence());
+            v.mDecoder.skip(n);
+            advanceLevel(v, n);
+            if (v.mDecoder.getRemaining() == 0) {
+                addEnd(v.mHandle, 0);
+                v = Voice();
+            }
+        }
+    }
+}
+
+int SoundMixer::mix(uint8_t* out, uint32_t count) {
+    // everything below a playing UI sound is turned down
+    bool duck = false;
+    int active = 0;
+    for (const Voice& v : mVoices) {
+        if (v.mSound) {
+            duck |= v.mPriority == SoundPriority::Ui && !v.mReleasing;
+            ++active;
+        }
+    }
+
+    // ducking ramps over a chunk, fades already under way carry on
+    for (Voice& v : mVoices) {
+        if (v.mSound && !v.mReleasing) {
+            const uint16_t gain = duck && v.mPriority < SoundPriority::Ui ? SOUND_DUCK_GAIN : SOUND_UNITY_GAIN;
+            if (((int32_t)gain << 8) != v.mTarget) {
+                setTarget(v, gain, SOUND_MIX_CHUNK);
+            }
+        }
+    }
+
+    uint16_t sum[SOUND_MIX_CHUNK];
+    uint32_t offset = 0;
+    while (count > 0) {
+        const uint32_t chunk = std::min<uint32_t>(count, SOUND_MIX_CHUNK);
+        memset(sum, 0, chunk * sizeof(uint16_t));
+        for (Voice& v : mVoices) {
+            if (v.mSound) {
+                mixVoice(v, sum, chunk, offset);
+            }
+        }
+        for (uint32_t i = 0; i < chunk; ++i) {
+            out[i] = sum[i] > 255 ? 255 : sum[i];
+        }
+        out += chunk;
+        count -= chunk;
+        offset += chunk;
+    }
+    return active;
+}
+
+void SoundMixer::mixVoice(Voice& voice, uint16_t* sum, uint32_t count, uint32_t offset) {
+    bool ended;
+    uint32_t done;
+    if (voice.mStep == SOUND_UNITY_STEP) {
+        done = mixDirect(voice, sum, count);
+        ended = voice.mDecoder.getRemaining() == 0;
+    }
+    else {
+        done = mixResampled(voice, sum, count);
+        ended = voice.mLive == 0;
+    }
+
+    // a stopped voice ends once it has faded out
+    if (voice.mReleasing && voice.mLevel == 0) {
+        ended = true;
+    }
+    if (ended) {
+        addEnd(voice.mHandle, offset + done);
+        voice = Voice();
+    }
+}
+
+uint32_t SoundMixer::mixDirect(Voice& voice, uint16_t* sum, uint32_t count) {
+    uint32_t done = 0;
+    while (done < count && voice.mDecoder.getRemaining() > 0) {
+        // silence adds nothing
+        uint32_t n = std::min(count - done, voice.mDecoder.getSilence());
+        if (n > 0) {
+            voice.mDecoder.skip(n);
+            advanceLevel(voice, n);
+            done += n;
+            continue;
+        }
+
+        // PCM is mixed straight from flash, anything else is decoded first
+        uint8_t decoded[SOUND_MIX_CHUNK];
+        const uint8_t* src = voice.mDecoder.getRawSamples();
+        n = std::min(count - done, voice.mDecoder.getAudible());
+        if (src) {
+            voice.mDecoder.skip(n);
+        }
+        else {
+            voice.mDecoder.decode(decoded, n);
+            src = decoded;
+        }
+        addSamples(voice, sum + done, src, n);
+        done += n;
+    }
+    return done;
+}
+
+uint32_t SoundMixer::mixResampled(Voice& voice, uint16_t* sum, uint32_t count) {
+    // the two samples carried over, then every source sample these outputs
+    // step over, decoded at once and reading silence past the end
+    uint8_t src[2 + SOUND_MIX_CHUNK * SOUND_MAX_RATE_RATIO];
+    const uint32_t needed = (uint32_t)(((uint64_t)voice.mPhase + (uint64_t)voice.mStep * count) >> 16);
+    src[0] = voice.mPrevious;
+    src[1] = voice.mNext;
+    const uint32_t got = voice.mDecoder.decode(src + 2, needed);
+    memset(src + 2 + got, 0, needed - got);
+
+    // the last sample that came from the sound, output stops once the
+    // interpolation has moved past it
+    int32_t last = got > 0 ? (int32_t)got + 1 : (voice.mLive & 1) ? 1 : (voice.mLive & 2) ? 0 : -1;
+
+    // no branching on the step, a fractional rate would mispredict
+    uint8_t out[SOUND_MIX_CHUNK];
+    const uint32_t step = voice.mStep;
+    uint32_t phase = voice.mPhase;
+    uint32_t position = 0;
+    uint32_t i = 0;
+    for (; i < count && (int32_t)position <= last; ++i) {
+        const int32_t previous = src[position];
+        const int32_t next = src[position + 1];
+        out[i] = (uint8_t)(previous + (((next - previous) * (int32_t)phase) >> 16));
+        phase += step;
+        position += phase >> 16;
+        phase &= SOUND_UNITY_STEP - 1;
+    }
+    voice.mPhase = phase;
+    voice.mPrevious = src[position];
+    voice.mNext = src[position + 1];
+    voice.mLive = (uint8_t)((((int32_t)position <= last) << 1) | ((int32_t)position + 1 <= last));
+
+    addSamples(voice, sum, out, i);
+    return i;
+}
+
+void SoundMixer::addSamples(Voice& voice, uint16_t* sum, const uint8_t* src, uint32_t count) {
+    if (voice.mLevel == voice.mTarget) {
+        if (voice.mLevel == SOUND_UNITY_GAIN << 8) {
+            for (uint32_t i = 0; i < count; ++i) {
+                sum[i] += src[i];
+            }
+        }
+        else {
+            const int32_t gain = voice.mLevel >> 8;
+            for (uint32_t i = 0; i < count; ++i) {
+                sum[i] += (src[i] * gain) >> 8;
+            }
+        }
+        return;
+    }
+
+    // a step a sample towards the target, so fades and ducking don't click
+    int32_t level = voice.mLevel;
+    const int32_t target = voice.mTarget;
+    const int32_t ramp = voice.mRamp;
+    for (uint32_t i = 0; i < count; ++i) {
+        sum[i] += (src[i] * (level >> 8)) >> 8;
+        if (level != target) {
+            level += ramp;
+            if (ramp > 0 ? level > target : level < target) {
+                level = target;
+            }
+        }
+    }
+    voice.mLevel = level;
+}
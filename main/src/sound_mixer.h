@@ -0,0 +1,140 @@
+#ifndef SOUND_MIXER_H
+#define SOUND_MIXER_H
+
+#include <stdint.h>
+#include <array>
+#include "sound_file.h"
+
+// how many sounds can play at once
+#ifndef SOUND_VOICES
+  #define SOUND_VOICES 4
+#endif
+
+// voice gains are 8.8 fixed point
+#define SOUND_UNITY_GAIN 256
+
+// gain of the other voices while a UI sound plays
+#ifndef SOUND_DUCK_GAIN
+  #define SOUND_DUCK_GAIN 96
+#endif
+
+// Output samples a sound takes to fade in from nothing, and to fade out
+// when it is stopped, so neither end clicks. Sounds that play to the end
+// aren't faded, they all finish on silence anyway.
+#ifndef SOUND_ATTACK_SAMPLES
+  #define SOUND_ATTACK_SAMPLES 32
+#endif
+#ifndef SOUND_RELEASE_SAMPLES
+  #define SOUND_RELEASE_SAMPLES 64
+#endif
+
+// sound rates are resampled to the output rate, from at most this many
+// times faster
+#define SOUND_MAX_RATE_RATIO 4
+
+enum class SoundPriority : uint8_t {
+    Effect,  // game sounds, layered over each other
+    Ui,      // beeps, ducks everything below it while it plays
+};
+
+// a voice that stopped, and how many samples into the last mix() it got
+struct SoundEnd {
+    uint32_t mHandle;
+    uint32_t mOffset;
+};
+
+// Mixes up to SOUND_VOICES sounds into 8 bit samples a block at a time.
+// Voices are summed in 16 bits and saturated, so loud overlaps clip
+// instead of wrapping around. A sound at another rate than the output is
+// resampled with linear interpolation as it plays. Every sound started
+// with a handle is reported once through getEnd() when it stops, whether
+// it finished, was stopped, or never got a voice. Only used from the
+// audio side.
+class SoundMixer {
+
+public:
+    // the rate mix() produces samples at
+    void setOutputRate(uint32_t rate) {
+        mOutputRate = rate;
+    }
+
+    // false if every voice is busy with a sound that outranks this one
+    bool start(const SoundFile* sound, SoundPriority priority, bool waitForSong, uint32_t handle = 0);
+    // fades every voice out, they end once they are silent
+    void stopAll();
+
+    // mixes the next count samples into out, returns the voices that played
+    int mix(uint8_t* out, uint32_t count);
+
+    // samples until any voice has something to play, 0 if one does now
+    // or nothing is playing
+    uint32_t getSilence() const;
+    // steps every voice over count samples of silence without mixing them
+    void skipSilence(uint32_t count);
+
+    bool isPlaying() const;
+    // any voice started with waitForSong
+    bool isPlayingSong() const;
+
+    // the sounds that stopped since the last clearEnds(), in order
+    int getEndCount() const {
+        return mEndCount;
+    }
+    const SoundEnd& getEnd(int index) const {
+        return mEnds[index];
+    }
+    // true if more sounds stopped than there was room to report
+    bool hasLostEnds() const {
+        return mLostEnds;
+    }
+    void clearEnds() {
+        mEndCount = 0;
+        mLostEnds = false;
+    }
+
+private:
+    struct Voice {
+        const SoundFile* mSound = nullptr;
+        SoundDecoder mDecoder;
+        SoundPriority mPriority = SoundPriority::Effect;
+        bool mWaitForSong = false;
+        bool mReleasing = false;
+        uint32_t mStartOrder = 0;
+        uint32_t mHandle = 0;
+
+        // gain in 8.8 fixed point shifted up 8 more bits, moving mRamp a
+        // sample towards mTarget
+        int32_t mLevel = 0;
+        int32_t mTarget = 0;
+        int32_t mRamp = 0;
+
+        // Resampling position as 16.16 fixed point, advancing mStep per
+        // output sample between the source samples mPrevious and mNext.
+        // mLive has bit 0 set if mNext came from the sound rather than
+        // past its end, and bit 1 for mPrevious.
+        uint32_t mStep = 1 << 16;
+        uint32_t mPhase = 0;
+        uint8_t mPrevious = 0;
+        uint8_t mNext = 0;
+        uint8_t mLive = 0;
+    };
+
+    void mixVoice(Voice& voice, uint16_t* sum, uint32_t count, uint32_t offset);
+    uint32_t mixDirect(Voice& voice, uint16_t* sum, uint32_t count);
+    uint32_t mixResampled(Voice& voice, uint16_t* sum, uint32_t count);
+    void addSamples(Voice& voice, uint16_t* sum, const uint8_t* src, uint32_t count);
+    void setTarget(Voice& voice, uint16_t gain, uint32_t samples);
+    void advanceLevel(Voice& voice, uint32_t count);
+    void addEnd(uint32_t handle, uint32_t offset);
+
+    std::array<Voice, SOUND_VOICES> mVoices;
+    uint32_t mStartCount = 0;
+    uint32_t mOutputRate = SOUND_DEFAULT_RATE;
+
+    // a mix can end every voice, and each command can steal or drop one
+    std::array<SoundEnd, SOUND_VOICES * 4> mEnds;
+    int mEndCount = 0;
+    bool mLostEnds = false;
+};
+
+#endif // SOUND_MIXER_H
@@ -0,0 +1,53 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <stdint.h>
+
+// A fixed size ring passing items from one producer to one consumer.
+// Neither side takes a lock or waits: each side only writes its own index,
+// and publishes it after the slot it covers has been written or read.
+template <typename T, uint32_t SIZE>
+class SpscRing {
+    static_assert((SIZE & (SIZE - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+    SpscRing() {}
+    // starts both indices at start rather than 0, so a test can run them
+    // across the point where they wrap around
+    explicit SpscRing(uint32_t start) : mHead(start), mTail(start) {}
+
+    // producer only, false when the ring is full
+    bool push(const T& item) {
+        const uint32_t head = mHead.load(std::memory_order_relaxed);
+        if (head - mTail.load(std::memory_order_acquire) == SIZE) {
+            return false;
+        }
+        mItems[head & (SIZE - 1)] = item;
+        mHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only, false when the ring is empty
+    bool pop(T& item) {
+        const uint32_t tail = mTail.load(std::memory_order_relaxed);
+        if (tail == mHead.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = mItems[tail & (SIZE - 1)];
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // either side, may be stale by the time it returns
+    bool empty() const {
+        return mHead.load(std::memory_order_acquire) == mTail.load(std::memory_order_acquire);
+    }
+
+private:
+    T mItems[SIZE];
+    std::atomic<uint32_t> mHead{0};
+    std::atomic<uint32_t> mTail{0};
+};
+
+#endif // SPSC_RING_H
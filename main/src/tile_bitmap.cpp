@@ -0,0 +1,109 @@
+#include <string.h>
+#include <algorithm>
+#include "tile_bitmap.h"
+
+#define TILE_OP_DIFF 0x40
+#define TILE_OP_LUMA 0x80
+#define TILE_OP_RUN  0xC0
+#define TILE_OP_RAW  0xFE
+
+static inline uint8_t colorHash(uint16_t color) {
+    const uint8_t r = color >> 11;
+    const uint8_t g = (color >> 5) & 0x3F;
+    const uint8_t b = color & 0x1F;
+    return (r * 3 + g * 5 + b * 7) & 63;
+}
+
+static inline uint16_t pack565(int r, int g, int b) {
+    return ((r & 0x1F) << 11) | ((g & 0x3F) << 5) | (b & 0x1F);
+}
+
+TileDecoder::TileDecoder(const TileBitmap& tile) {
+    mData = tile.data;
+    mEnd = tile.data + tile.size;
+    mCodec = tile.codec;
+    mWidth = tile.width;
+}
+
+uint16_t TileDecoder::nextPixel() {
+    if (mRun > 0) {
+        --mRun;
+        return mPrev;
+    }
+
+    // a truncated stream, or an op cut short at its end, ends the tile in
+    // black rather than reading past the data
+    const uint8_t op = mData < mEnd ? *mData : 0;
+    const int length = op == TILE_OP_RAW ? 3 : (op >= TILE_OP_LUMA && op < TILE_OP_RUN ? 2 : 1);
+    if (mEnd - mData < length) {
+        mData = mEnd;
+        mPrev = 0;
+        return mPrev;
+    }
+    ++mData;
+
+    const int r = mPrev >> 11;
+    const int g = (mPrev >> 5) & 0x3F;
+    const int b = mPrev & 0x1F;
+    if (op == TILE_OP_RAW) {
+        mPrev = (mData[0] << 8) | mData[1];
+        mData += 2;
+    }
+    else if (op >= TILE_OP_RUN) {
+        mRun = op & 0x3F;
+        return mPrev;
+    }
+    else if (op >= TILE_OP_LUMA) {
+        const int dg = (op & 0x3F) - 32;
+        const uint8_t second = *mData++;
+        const int dr = (second >> 4) - 8 + (dg >> 1);
+        const int db = (second & 0x0F) - 8 + (dg >> 1);
+        mPrev = pack565(r + dr, g + dg, b + db);
+    }
+    else if (op >= TILE_OP_DIFF) {
+        mPrev = pack565(r + ((op >> 4) & 3) - 2, g + ((op >> 2) & 3) - 2, b + (op & 3) - 2);
+    }
+    else {
+        mPrev = mIndex[op];
+        return mPrev;
+    }
+    mIndex[colorHash(mPrev)] = mPrev;
+    return mPrev;
+}
+
+void TileDecoder::decodeRow(uint16_t* dst, bool bigEndian) {
+    if (mCodec == TileCodec::Raw) {
+        // short data leaves the rest of the row black
+        const uint32_t bytes = std::min<uint32_t>(mWidth * 2, mEnd - mData);
+        memcpy(dst, mData, bytes);
+        memset((uint8_t*)dst + bytes, 0, mWidth * 2 - bytes);
+        mData += bytes;
+        if (!bigEndian) {
+            for (int i = 0; i < mWidth; ++i) {
+                dst[i] = __builtin_bswap16(dst[i]);
+            }
+        }
+        return;
+    }
+
+    if (bigEndian) {
+        for (int i = 0; i < mWidth; ++i) {
+            dst[i] = __builtin_bswap16(nextPixel());
+        }
+    }
+    else {
+        for (int i = 0; i < mWidth; ++i) {
+            dst[i] = nextPixel();
+        }
+    }
+}
+
+void TileDecoder::skipRows(int rows) {
+    if (mCodec == TileCodec::Raw) {
+        mData += std::min<uint32_t>(rows * mWidth * 2, mEnd - mData);
+        return;
+    }
+    for (int i = 0; i < rows * mWidth; ++i) {
+        nextPixel();
+    }
+}
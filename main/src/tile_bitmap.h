@@ -0,0 +1,50 @@
+#ifndef TILE_BITMAP_H
+#define TILE_BITMAP_H
+
+#include <Arduino.h>
+#include <array>
+
+#define TILE_MAX_WIDTH 120
+// most pixels one op of the compressed stream can produce, a full run
+#define TILE_MAX_OP_PIXELS 62
+
+enum class TileCodec : uint8_t {
+    Qoi,  // compressed, see tools/tile_codec.py for the format
+    Raw,  // big-endian RGB565, twice the size but copied straight out
+};
+
+// an RGB565 tile
+struct TileBitmap
+{
+  uint16_t width;
+  uint16_t height;
+  uint32_t size;
+  const uint8_t * data;
+  TileCodec codec = TileCodec::Qoi;
+};
+
+// Streams a TileBitmap out one scanline at a time, so drawing a tile never
+// needs more than a row of decoded pixels.
+class TileDecoder {
+public:
+    TileDecoder() {}
+    explicit TileDecoder(const TileBitmap& tile);
+
+    // writes the next tile.width pixels to dst, optionally byte-swapped to
+    // the panel's big-endian order so they can be sent without conversion
+    void decodeRow(uint16_t* dst, bool bigEndian = false);
+    void skipRows(int rows);
+
+private:
+    uint16_t nextPixel();
+
+    const uint8_t* mData = nullptr;
+    const uint8_t* mEnd = nullptr;
+    TileCodec mCodec = TileCodec::Qoi;
+    uint16_t mWidth = 0;
+    uint16_t mPrev = 0;
+    uint8_t mRun = 0;
+    std::array<uint16_t, 64> mIndex = {};
+};
+
+#endif // TILE_BITMAP_H
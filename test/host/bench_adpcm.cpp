@@ -0,0 +1,158 @@
+// What the game's sounds cost to decode, and what ADPCM did to them:
+// every sound in assets/sounds.h decoded a block at a time, timed against
+// the same samples stored as PCM, and compared with the originals in
+// audio/*.wav.
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "host_stubs.h"
+#include "test_check.h"
+#include "sound_manager.h"
+#include "assets/sounds.h"
+
+#define SOUND(name) { #name, &name##_snd }
+
+static const struct {
+    const char* mName;
+    const SoundFile* mSound;
+} sSounds[] = {
+    SOUND(battle), SOUND(bazaar), SOUND(bazaar_closed), SOUND(beep), SOUND(clear),
+    SOUND(darktower), SOUND(dragon), SOUND(dragon_kill), SOUND(end_turn), SOUND(enemy_hit),
+    SOUND(frontier), SOUND(intro), SOUND(lost), SOUND(pegasus), SOUND(plague),
+    SOUND(player_hit), SOUND(rotate), SOUND(sanctuary), SOUND(starving), SOUND(tomb),
+    SOUND(tomb_battle), SOUND(tomb_nothing), SOUND(wrong),
+};
+
+static const int ROUNDS = 20;
+
+// Just under what the codec measures now, 19.5 dB over every sound and
+// 11.4 dB for the worst one (wrong), so a codec change that loses quality
+// fails the bench instead of only printing a lower figure.
+static const double MIN_SNR_DB = 18.0;
+static const double MIN_SOUND_SNR_DB = 11.0;
+
+static double snrDb(double signal, double noise) {
+    return 10 * log10(signal / std::max(noise, 1.0));
+}
+
+// the samples of an 8 bit mono wav file, empty if it can't be read
+static std::vector<uint8_t> readWav(const char* name) {
+    std::vector<uint8_t> samples;
+    char path[256];
+    snprintf(path, sizeof(path), "../../audio/%s.wav", name);
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return samples;
+    }
+    uint8_t header[12];
+    if (fread(header, 1, 12, file) == 12 && memcmp(header, "RIFF", 4) == 0 && memcmp(header + 8, "WAVE", 4) == 0) {
+        uint8_t chunk[8];
+        while (fread(chunk, 1, 8, file) == 8) {
+            const uint32_t length = chunk[4] | (chunk[5] << 8) | (chunk[6] << 16) | ((uint32_t)chunk[7] << 24);
+            if (memcmp(chunk, "data", 4) == 0) {
+                samples.resize(length);
+                samples.resize(fread(samples.data(), 1, length, file));
+                break;
+            }
+            fseek(file, length + (length & 1), SEEK_CUR);
+        }
+    }
+    fclose(file);
+    return samples;
+}
+
+static std::vector<uint8_t> decodeAll(const SoundFile& sound) {
+    std::vector<uint8_t> out(sound.size);
+    SoundDecoder decoder(sound);
+    for (uint32_t at = 0; at < sound.size;) {
+        at += decoder.decode(out.data() + at, std::min<uint32_t>(SOUND_BLOCK_SAMPLES, sound.size - at));
+    }
+    return out;
+}
+
+static double nsPerSample(const SoundFile& sound) {
+    using namespace std::chrono;
+    const auto start = steady_clock::now();
+    uint32_t check = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        check += decodeAll(sound)[sound.size / 2];
+    }
+    const double ns = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    return check == 0xFFFFFFFF ? 0 : ns / ((double)ROUNDS * sound.size);
+}
+
+int main() {
+    Serial.mEcho = false;
+    printf("%-14s %7s %7s %7s %8s %8s %8s\n", "sound", "samples", "stored", "ratio", "SNR dB", "ADPCM ns", "PCM ns");
+
+    uint32_t totalSamples = 0;
+    uint32_t totalStored = 0;
+    double adpcmNs = 0;
+    double pcmNs = 0;
+    double signal = 0;
+    double noise = 0;
+    for (const auto& entry : sSounds) {
+        const SoundFile& sound = *entry.mSound;
+        const std::vector<uint8_t> original = readWav(entry.mName);
+        if (original.size() != sound.size) {
+            printf("%s: no matching audio/%s.wav\n", entry.mName, entry.mName);
+            return 1;
+        }
+
+        // the same sound stored as PCM, silence runs and all
+        std::vector<uint8_t> audible;
+        SoundDecoder runs(sound);
+        for (uint32_t at = 0; at < sound.size;) {
+            const uint32_t silence = runs.getSilence();
+            if (silence) {
+                runs.skip(silence);
+                at += silence;
+                continue;
+            }
+            const uint32_t stored = runs.getAudible();
+            audible.insert(audible.end(), original.begin() + at, original.begin() + at + stored);
+            runs.skip(stored);
+            at += stored;
+        }
+        SoundFile pcm = sound;
+        pcm.codec = SoundCodec::Pcm8;
+        pcm.data = audible.data();
+
+        const std::vector<uint8_t> decoded = decodeAll(sound);
+        CHECK(decodeAll(pcm) == original);
+        // as tools/sound_codec.py measures it, against the signal's variance
+        double mean = 0;
+        for (uint8_t sample : original) {
+            mean += sample;
+        }
+        mean /= sound.size;
+        double soundSignal = 0;
+        double soundNoise = 0;
+        for (uint32_t i = 0; i < sound.size; ++i) {
+            const double error = (double)decoded[i] - original[i];
+            soundSignal += (original[i] - mean) * (original[i] - mean);
+            soundNoise += error * error;
+        }
+        signal += soundSignal;
+        noise += soundNoise;
+        const double soundSnr = snrDb(soundSignal, soundNoise);
+        CHECK(soundSnr >= MIN_SOUND_SNR_DB);
+
+        const uint32_t stored = (sound.codec == SoundCodec::Pcm8 ? audible.size() : (audible.size() + 1) / 2)
+                                + sound.silenceCount * sizeof(SoundRun);
+        const double adpcm = nsPerSample(sound);
+        const double raw = nsPerSample(pcm);
+        totalSamples += sound.size;
+        totalStored += stored;
+        adpcmNs += adpcm * sound.size;
+        pcmNs += raw * sound.size;
+        printf("%-14s %7u %7u %6.0f%% %8.1f %8.2f %8.2f\n", entry.mName, sound.size, stored,
+               100.0 * stored / sound.size, soundSnr, adpcm, raw);
+    }
+    const double snr = snrDb(signal, noise);
+    printf("%-14s %7u %7u %6.0f%% %8.1f %8.2f %8.2f\n", "all", totalSamples, totalStored,
+           100.0 * totalStored / totalSamples, snr, adpcmNs / totalSamples, pcmNs / totalSamples);
+    CHECK(snr >= MIN_SNR_DB);
+    return testResult("bench_adpcm");
+}
@@ -0,0 +1,109 @@
+// What SoundMixer::mix() costs per output sample, mixing blocks the size
+// the DMA path uses, with 1, 2 and 4 voices playing at once, with sounds
+// at other rates than the output being resampled, and with every sample
+// inside a fade in or out.
+
+#include <chrono>
+#include <vector>
+#include "host_stubs.h"
+#include "sound_manager.h"
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+#endif
+
+static const uint32_t SOUND_LENGTH = 1 << 20;
+static const uint32_t MIXED_SAMPLES = 1 << 19;
+
+// TSC cycles where there is one, 0 elsewhere
+static uint64_t cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// mixes MIXED_SAMPLES with startVoices() called whenever nothing plays,
+// and a block at a time from whatever mixBlock() does
+template <typename Start, typename Block>
+static void measure(const char* name, Start startVoices, Block mixBlock) {
+    SoundMixer mixer;
+    mixer.setOutputRate(SOUND_SAMPLE_RATE);
+    static uint8_t block[SOUND_BLOCK_SAMPLES];
+    uint32_t check = 0;
+
+    using namespace std::chrono;
+    const auto start = steady_clock::now();
+    const uint64_t startCycles = cycles();
+    for (uint32_t mixed = 0; mixed < MIXED_SAMPLES;) {
+        if (!mixer.isPlaying()) {
+            startVoices(mixer);
+        }
+        mixed += mixBlock(mixer, block);
+        check += block[mixed & (SOUND_BLOCK_SAMPLES - 1)];
+    }
+    const double ns = duration_cast<nanoseconds>(steady_clock::now() - start).count();
+    const double tsc = cycles() - startCycles;
+    if (check == 0) {
+        printf("nothing was mixed\n");
+    }
+    printf("%-34s %6.2f ns %6.2f cycles per sample\n", name, ns / MIXED_SAMPLES, tsc / MIXED_SAMPLES);
+}
+
+static uint32_t mixWholeBlock(SoundMixer& mixer, uint8_t* block) {
+    mixer.mix(block, SOUND_BLOCK_SAMPLES);
+    return SOUND_BLOCK_SAMPLES;
+}
+
+// voices start, fade in, are stopped and fade out, never at full level
+static uint32_t mixFades(SoundMixer& mixer, uint8_t* block) {
+    mixer.mix(block, SOUND_ATTACK_SAMPLES);
+    mixer.stopAll();
+    mixer.mix(block, SOUND_RELEASE_SAMPLES);
+    return SOUND_ATTACK_SAMPLES + SOUND_RELEASE_SAMPLES;
+}
+
+int main() {
+    Serial.mEcho = false;
+
+    // noise, so nothing is skipped as silence
+    std::vector<std::vector<uint8_t>> data(SOUND_VOICES);
+    std::vector<SoundFile> sounds;
+    for (int i = 0; i < SOUND_VOICES; ++i) {
+        data[i].resize(SOUND_LENGTH);
+        for (uint8_t& sample : data[i]) {
+            sample = 1 + rand() % 255;
+        }
+        sounds.push_back({ SOUND_LENGTH, data[i].data() });
+    }
+    auto atRate = [&](uint32_t rate) {
+        for (SoundFile& sound : sounds) {
+            sound.rate = rate;
+        }
+    };
+    auto voices = [&](int count, bool withBeep = false) {
+        return [&, count, withBeep](SoundMixer& mixer) {
+            for (int i = 0; i < count; ++i) {
+                const bool beep = withBeep && i == count - 1;
+                mixer.start(&sounds[i], beep ? SoundPriority::Ui : SoundPriority::Effect, false);
+            }
+        };
+    };
+
+    printf("8 bit PCM voices, output at %d Hz, %d sample blocks\n", SOUND_SAMPLE_RATE, SOUND_BLOCK_SAMPLES);
+    atRate(SOUND_SAMPLE_RATE);
+    measure("1 voice", voices(1), mixWholeBlock);
+    measure("2 voices", voices(2), mixWholeBlock);
+    measure("4 voices", voices(4), mixWholeBlock);
+    measure("3 voices ducked by a UI beep", voices(4, true), mixWholeBlock);
+    measure("4 voices fading in and out", voices(4), mixFades);
+
+    atRate(11025);
+    measure("1 voice resampled from 11025 Hz", voices(1), mixWholeBlock);
+    measure("4 voices resampled from 11025 Hz", voices(4), mixWholeBlock);
+    atRate(16000);
+    measure("1 voice resampled from 16000 Hz", voices(1), mixWholeBlock);
+    measure("4 voices resampled from 16000 Hz", voices(4), mixWholeBlock);
+    measure("4 at 16000 Hz fading in and out", voices(4), mixFades);
+    return 0;
+}
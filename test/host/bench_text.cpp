@@ -0,0 +1,81 @@
+// Pixels sent and time taken to draw a screen's worth of centered text:
+// measuring each string by printing it in black first, as drawTextCentered
+// used to, against summing glyph advances with measureText().
+
+#include <chrono>
+#include "host_stubs.h"
+#include "display_manager.h"
+#include "assets/SerifGothicStd_Bold12pt7b.h"
+#include "assets/SerifGothicStd_Bold20pt7b.h"
+
+static const char* const sLines[] = {
+    "Warriors: 10", "Gold: 30", "Food: 25", "Beast", "Scout", "Healer",
+    "Buy Food", "Buy Warriors", "Cancel", "Brass Key", "Silver Key",
+};
+static const int LINE_COUNT = sizeof(sLines) / sizeof(sLines[0]);
+static const int ROUNDS = 2000;
+
+static uint32_t elapsedUs(std::chrono::steady_clock::time_point start) {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+
+// the way drawTextCentered worked before
+static void drawPrintMeasured(Adafruit_GFX& gfx, const String& text, int y) {
+    gfx.setCursor(0, y);
+    gfx.setTextColor(ST77XX_BLACK);
+    gfx.print(text);
+    int16_t inset = 120 - (gfx.getCursorX() >> 1);
+    gfx.setCursor(std::max<int16_t>(inset, 0), y);
+    gfx.setTextColor(ST77XX_WHITE);
+    gfx.print(text);
+}
+
+static void drawMetricMeasured(Adafruit_GFX& gfx, const String& text, int y) {
+    int16_t inset = 120 - (DisplayManager::measureText(text, &SerifGothicStd_Bold12pt7b) >> 1);
+    gfx.setCursor(std::max<int16_t>(inset, 0), y);
+    gfx.setTextColor(ST77XX_WHITE);
+    gfx.print(text);
+}
+
+template <typename Draw>
+static void bench(const char* name, Draw draw) {
+    Adafruit_ST7789 panel(0, 0, 0);
+    panel.setFont(&SerifGothicStd_Bold12pt7b);
+    panel.setTextWrap(false);
+
+    for (int i = 0; i < LINE_COUNT; ++i) {
+        draw(panel, sLines[i], 40 + i * 23);
+    }
+    const uint32_t bytes = panel.mBytesSent;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (int i = 0; i < LINE_COUNT; ++i) {
+            draw(panel, sLines[i], 40 + i * 23);
+        }
+    }
+    const uint32_t us = elapsedUs(start);
+    printf("%-22s %6u pixels per screen, %6.2f us per screen\n", name, bytes / 2, (double)us / ROUNDS);
+}
+
+int main() {
+    Serial.mEcho = false;
+    printf("%d centered lines in SerifGothicStd_Bold12pt7b\n", LINE_COUNT);
+    bench("print to measure", drawPrintMeasured);
+    bench("glyph metrics", drawMetricMeasured);
+
+    // with the width cache, a menu drawn again doesn't walk the glyphs
+    DisplayManager display;
+    display.setup();
+    const auto start = std::chrono::steady_clock::now();
+    int32_t total = 0;
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (int i = 0; i < LINE_COUNT; ++i) {
+            total += display.measureText(sLines[i]);
+        }
+    }
+    printf("%-22s %6.2f us per screen of widths (%d)\n", "cached metrics",
+        (double)elapsedUs(start) / ROUNDS, (int)(total / ROUNDS));
+    return 0;
+}
@@ -0,0 +1,130 @@
+// Decoding and upscaling every tile into the frame canvas, the way a
+// screen paints its bitmap: compressed tiles against the same tiles
+// stored raw, with the bytes each has to read from flash. Then the
+// scanlines sent to the panel, made in native byte order for the SPI
+// driver to swap against made in panel order and sent as they are.
+
+#include <chrono>
+#include <vector>
+#include "host_stubs.h"
+#include "display_manager.h"
+#include "assets/images.h"
+
+static const int ROUNDS = 200;
+
+static double usPerTile(DisplayManager& display, const std::vector<TileBitmap>& tiles) {
+    using namespace std::chrono;
+    const auto start = steady_clock::now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (const TileBitmap& tile : tiles) {
+            display.drawRGBBitmap2X(0, 32, &tile);
+        }
+    }
+    const double us = duration_cast<nanoseconds>(steady_clock::now() - start).count() / 1000.0;
+    return us / ROUNDS / tiles.size();
+}
+
+// what drawRGBBitmap2X did per row pair before pixels were kept in panel
+// order: double 16 bits at a time, then the driver swaps all four copies
+static uint32_t paintNativeOrder(const TileBitmap& tile, uint16_t* row, uint16_t* scanline, uint16_t* wire) {
+    TileDecoder decoder(tile);
+    const int16_t w = tile.width;
+    uint32_t check = 0;
+    for (int16_t line = 0; line < tile.height; ++line) {
+        decoder.decodeRow(row);
+        for (int src = 0; src < w; ++src) {
+            scanline[src*2] = row[src];
+            scanline[src*2+1] = row[src];
+        }
+        memcpy(scanline + w*2, scanline, w*2*sizeof(uint16_t));
+        for (int i = 0; i < w*4; ++i) {
+            wire[i] = __builtin_bswap16(scanline[i]);
+        }
+        check += wire[line];
+    }
+    return check;
+}
+
+// and now: swapped once per source pixel as it is decoded, doubled as
+// 32-bit pairs, and sent without a swap
+static uint32_t paintPanelOrder(const TileBitmap& tile, uint16_t* row, uint16_t* scanline, uint16_t* wire) {
+    TileDecoder decoder(tile);
+    const int16_t w = tile.width;
+    uint32_t check = 0;
+    for (int16_t line = 0; line < tile.height; ++line) {
+        decoder.decodeRow(row, true);
+        uint32_t* dst32 = (uint32_t*)scanline;
+        for (int src = 0; src < w; ++src) {
+            const uint32_t color = row[src];
+            dst32[src] = color | (color << 16);
+        }
+        memcpy(scanline + w*2, scanline, w*2*sizeof(uint16_t));
+        memcpy(wire, scanline, w*4*sizeof(uint16_t));
+        check += wire[line];
+    }
+    return check;
+}
+
+template <typename Paint>
+static double usPerPaint(const std::vector<TileBitmap>& tiles, Paint paint, uint32_t& check) {
+    using namespace std::chrono;
+    static uint16_t row[TILE_MAX_WIDTH];
+    alignas(4) static uint16_t scanline[480];
+    static uint16_t wire[480];
+    const auto start = steady_clock::now();
+    for (int round = 0; round < ROUNDS; ++round) {
+        for (const TileBitmap& tile : tiles) {
+            check += paint(tile, row, scanline, wire);
+        }
+    }
+    const double us = duration_cast<nanoseconds>(steady_clock::now() - start).count() / 1000.0;
+    return us / ROUNDS / tiles.size();
+}
+
+int main() {
+    Serial.mEcho = false;
+    DisplayManager display;
+    display.setup();
+
+    // the same pixels stored raw, big-endian as the raw codec expects
+    std::vector<TileBitmap> packed;
+    std::vector<TileBitmap> raw;
+    std::vector<std::vector<uint16_t>> rawData(tile_bitmap_allArray_LEN);
+    uint32_t packedBytes = 0;
+    uint32_t rawBytes = 0;
+    for (int i = 0; i < tile_bitmap_allArray_LEN; ++i) {
+        const TileBitmap& tile = *tile_bitmap_allArray[i];
+        packed.push_back(tile);
+        packedBytes += tile.size;
+
+        rawData[i].resize(tile.width * tile.height);
+        TileDecoder decoder(tile);
+        for (int row = 0; row < tile.height; ++row) {
+            decoder.decodeRow(rawData[i].data() + row * tile.width, true);
+        }
+        const uint32_t size = tile.width * tile.height * 2;
+        raw.push_back({tile.width, tile.height, size, (const uint8_t*)rawData[i].data(), TileCodec::Raw});
+        rawBytes += size;
+    }
+
+    const double packedUs = usPerTile(display, packed);
+    const double rawUs = usPerTile(display, raw);
+    printf("%d tiles, decoded and upscaled 2x into the canvas\n", tile_bitmap_allArray_LEN);
+    printf("raw         %7u bytes read, %6.1f us per tile\n", rawBytes, rawUs);
+    printf("compressed  %7u bytes read, %6.1f us per tile\n", packedBytes, packedUs);
+    printf("compressed reads %.0f%% of the bytes and takes %.2fx the time\n",
+        100.0 * packedBytes / rawBytes, packedUs / rawUs);
+
+    uint32_t nativeCheck = 0;
+    uint32_t panelCheck = 0;
+    printf("scanlines for the panel, raw tiles so only the pixel handling differs\n");
+    const double nativeUs = usPerPaint(raw, paintNativeOrder, nativeCheck);
+    const double panelUs = usPerPaint(raw, paintPanelOrder, panelCheck);
+    printf("native order, driver swaps  %6.1f us per tile\n", nativeUs);
+    printf("panel order, no swap        %6.1f us per tile\n", panelUs);
+    if (nativeCheck != panelCheck) {
+        printf("the two paths sent different pixels\n");
+        return 1;
+    }
+    return 0;
+}
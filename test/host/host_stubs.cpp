@@ -0,0 +1,281 @@
+#include "host_stubs.h"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+#include <FreeRTOS.h>
+#include <task.h>
+#include <event_groups.h>
+#include <esp_partition.h>
+#include <driver/dac_continuous.h>
+
+HWSerial Serial;
+
+static uint64_t sNowUs = 0;
+static bool sRealClock = false;
+
+static uint64_t nowUs() {
+    if (sRealClock) {
+        using namespace std::chrono;
+        return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+    return sNowUs;
+}
+
+void hostSetTime(uint64_t us) {
+    sNowUs = us;
+}
+
+void hostAdvanceTime(uint64_t us) {
+    sNowUs += us;
+}
+
+void hostUseRealClock(bool real) {
+    sRealClock = real;
+}
+
+unsigned long millis() {
+    return (unsigned long)(uint32_t)(nowUs() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)(uint32_t)nowUs();
+}
+
+void delay(unsigned long ms) {
+    sNowUs += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+    sNowUs += us;
+}
+
+long random(long max) {
+    return max > 0 ? rand() % max : 0;
+}
+
+long random(long min, long max) {
+    return max > min ? min + rand() % (max - min) : min;
+}
+
+struct Pin {
+    int mLevel = HIGH;
+    void (*mHandler)(void*) = nullptr;
+    void* mArg = nullptr;
+};
+static std::map<int, Pin> sPins;
+
+void pinMode(int, int) {}
+
+int digitalRead(int pin) {
+    return sPins[pin].mLevel;
+}
+
+void digitalWrite(int pin, int level) {
+    sPins[pin].mLevel = level;
+}
+
+void dacWrite(int, uint8_t) {}
+
+int digitalPinToInterrupt(int pin) {
+    return pin;
+}
+
+void attachInterruptArg(int interrupt, void (*handler)(void*), void* arg, int) {
+    sPins[interrupt].mHandler = handler;
+    sPins[interrupt].mArg = arg;
+}
+
+void detachInterrupt(int interrupt) {
+    sPins[interrupt].mHandler = nullptr;
+}
+
+void hostSetPin(int pin, int level) {
+    Pin& state = sPins[pin];
+    if (state.mLevel == level) {
+        return;
+    }
+    state.mLevel = level;
+    if (state.mHandler) {
+        state.mHandler(state.mArg);
+    }
+}
+
+void hostSetPinQuietly(int pin, int level) {
+    sPins[pin].mLevel = level;
+}
+
+void hostFirePin(int pin) {
+    Pin& state = sPins[pin];
+    if (state.mHandler) {
+        state.mHandler(state.mArg);
+    }
+}
+
+bool psramFound() {
+    return true;
+}
+
+void* ps_malloc(size_t bytes) {
+    return malloc(bytes);
+}
+
+// started and stopped from both sides of a test that runs an audio thread
+struct esp_timer {
+    esp_timer_create_args_t mArgs;
+    std::atomic<bool> mActive{false};
+};
+static std::vector<esp_timer*> sTimers;
+static void (*sStopHook)(esp_timer_handle_t, void*) = nullptr;
+static void* sStopHookContext = nullptr;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+    esp_timer* timer = new esp_timer;
+    timer->mArgs = *args;
+    sTimers.push_back(timer);
+    *handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t) {
+    if (timer->mActive.exchange(true)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t) {
+    return esp_timer_start_periodic(timer, 0);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (sStopHook) {
+        sStopHook(timer, sStopHookContext);
+    }
+    if (!timer->mActive.exchange(false)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    return timer->mActive;
+}
+
+int64_t esp_timer_get_time() {
+    return (int64_t)nowUs();
+}
+
+esp_timer_handle_t hostFindTimer(const char* name) {
+    for (esp_timer* timer : sTimers) {
+        if (timer->mArgs.name && strcmp(timer->mArgs.name, name) == 0) {
+            return timer;
+        }
+    }
+    return nullptr;
+}
+
+void hostBeforeTimerStop(void (*hook)(esp_timer_handle_t, void*), void* context) {
+    sStopHook = hook;
+    sStopHookContext = context;
+}
+
+bool hostFireTimer(esp_timer_handle_t timer) {
+    if (!timer || !timer->mActive) {
+        return false;
+    }
+    timer->mArgs.callback(timer->mArgs.arg);
+    return true;
+}
+
+// tasks are never run, a test calls what the task would have
+BaseType_t xTaskCreate(void (*)(void*), const char*, uint32_t, void*, int, TaskHandle_t* handle) {
+    static int sTask;
+    if (handle) {
+        *handle = &sTask;
+    }
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) {
+    return 0;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t) {
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t*) {}
+
+void vTaskDelete(TaskHandle_t) {}
+
+void vTaskDelay(TickType_t ticks) {
+    if (sRealClock) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+        return;
+    }
+    sNowUs += (uint64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+EventGroupHandle_t xEventGroupCreateStatic(StaticEventGroup_t* buffer) {
+    memset(buffer, 0, sizeof(*buffer));
+    return buffer;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+    EventBits_t* current = (EventBits_t*)group;
+    *current |= bits;
+    return *current;
+}
+
+BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t group, EventBits_t bits, BaseType_t*) {
+    xEventGroupSetBits(group, bits);
+    return pdPASS;
+}
+
+// never blocks, the time it would have waited is just skipped
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear, BaseType_t, TickType_t ticks) {
+    EventBits_t* current = (EventBits_t*)group;
+    const EventBits_t set = *current;
+    if ((set & bits) == 0 && ticks != portMAX_DELAY) {
+        sNowUs += (uint64_t)ticks * portTICK_PERIOD_MS * 1000;
+    }
+    if (clear) {
+        *current &= ~bits;
+    }
+    return set;
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t, esp_partition_subtype_t, const char*) {
+    return nullptr;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t*, size_t, size_t, esp_partition_mmap_memory_t, const void**, esp_partition_mmap_handle_t*) {
+    return -1;
+}
+
+esp_err_t dac_continuous_new_channels(const dac_continuous_config_t*, dac_continuous_handle_t* handle) {
+    static int sChannels;
+    *handle = (dac_continuous_handle_t)&sChannels;
+    return ESP_OK;
+}
+
+esp_err_t dac_continuous_del_channels(dac_continuous_handle_t) {
+    return ESP_OK;
+}
+
+esp_err_t dac_continuous_enable(dac_continuous_handle_t) {
+    return ESP_OK;
+}
+
+esp_err_t dac_continuous_disable(dac_continuous_handle_t) {
+    return ESP_OK;
+}
+
+esp_err_t dac_continuous_write(dac_continuous_handle_t, uint8_t*, size_t size, size_t* written, int) {
+    if (written) {
+        *written = size;
+    }
+    return ESP_OK;
+}
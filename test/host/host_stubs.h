@@ -0,0 +1,31 @@
+#ifndef HOST_STUBS_H
+#define HOST_STUBS_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+// What a test uses to drive the stand-ins in stubs/. Time doesn't pass on
+// its own: millis(), micros() and esp_timer_get_time() read a clock that
+// only moves when a test moves it, unless the real clock is asked for.
+
+void hostSetTime(uint64_t us);
+void hostAdvanceTime(uint64_t us);
+// benches time real work, so they read the host's clock instead
+void hostUseRealClock(bool real);
+
+// sets a pin's level, calling its interrupt handler if the level changed
+void hostSetPin(int pin, int level);
+// sets a pin's level without its interrupt, as if the handler hadn't run
+// yet, and runs the handler later, reading whatever the pin is by then
+void hostSetPinQuietly(int pin, int level);
+void hostFirePin(int pin);
+
+// the timer created with this name, nullptr if there isn't one
+esp_timer_handle_t hostFindTimer(const char* name);
+// runs the timer's callback as if it had gone off, false if it isn't active
+bool hostFireTimer(esp_timer_handle_t timer);
+// called with a timer just before esp_timer_stop() stops it, so a test can
+// land something in the gap between deciding to stop and stopping
+void hostBeforeTimerStop(void (*hook)(esp_timer_handle_t timer, void* context), void* context);
+
+#endif // HOST_STUBS_H
@@ -0,0 +1,135 @@
+#ifndef HOST_ADAFRUIT_GFX_H
+#define HOST_ADAFRUIT_GFX_H
+
+#include <Arduino.h>
+
+// The parts of Adafruit_GFX the game uses. Custom font text is drawn the
+// way the library draws it, one writePixel() per set bit, so what a test
+// sees on the stand-in panel is what the real one would show.
+
+typedef struct {
+    uint16_t bitmapOffset;
+    uint8_t width;
+    uint8_t height;
+    uint8_t xAdvance;
+    int8_t xOffset;
+    int8_t yOffset;
+} GFXglyph;
+
+typedef struct {
+    uint8_t* bitmap;
+    GFXglyph* glyph;
+    uint16_t first;
+    uint16_t last;
+    uint8_t yAdvance;
+} GFXfont;
+
+class Adafruit_GFX : public Print {
+
+public:
+    Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {}
+
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+    virtual void startWrite() {}
+    virtual void endWrite() {}
+    virtual void writePixel(int16_t x, int16_t y, uint16_t color) {
+        drawPixel(x, y, color);
+    }
+    virtual void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        fillRect(x, y, w, h, color);
+    }
+
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+        for (int16_t row = y; row < y + h; ++row) {
+            for (int16_t col = x; col < x + w; ++col) {
+                drawPixel(col, row, color);
+            }
+        }
+    }
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+        fillRect(x, y, w, 1, color);
+    }
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+        fillRect(x, y, 1, h, color);
+    }
+    virtual void fillScreen(uint16_t color) {
+        fillRect(0, 0, _width, _height, color);
+    }
+    virtual void setRotation(uint8_t) {}
+
+    void drawRGBBitmap(int16_t x, int16_t y, const uint16_t* bitmap, int16_t w, int16_t h) {
+        startWrite();
+        for (int16_t row = 0; row < h; ++row) {
+            for (int16_t col = 0; col < w; ++col) {
+                writePixel(x + col, y + row, bitmap[row * w + col]);
+            }
+        }
+        endWrite();
+    }
+
+    void setFont(const GFXfont* font) {
+        gfxFont = (GFXfont*)font;
+    }
+    void setTextWrap(bool w) {
+        wrap = w;
+    }
+    void setCursor(int16_t x, int16_t y) {
+        cursor_x = x;
+        cursor_y = y;
+    }
+    void setTextColor(uint16_t color) {
+        textcolor = color;
+    }
+    void setTextColor(uint16_t color, uint16_t) {
+        textcolor = color;
+    }
+    int16_t getCursorX() const {
+        return cursor_x;
+    }
+    int16_t getCursorY() const {
+        return cursor_y;
+    }
+    int16_t width() const {
+        return _width;
+    }
+    int16_t height() const {
+        return _height;
+    }
+
+    size_t write(uint8_t c) override {
+        if (!gfxFont || c < gfxFont->first || c > gfxFont->last) {
+            return 1;
+        }
+        const GFXglyph& glyph = gfxFont->glyph[c - gfxFont->first];
+        const uint8_t* bits = gfxFont->bitmap + glyph.bitmapOffset;
+        uint8_t byte = 0;
+        uint16_t bit = 0;
+        startWrite();
+        for (uint8_t yy = 0; yy < glyph.height; ++yy) {
+            for (uint8_t xx = 0; xx < glyph.width; ++xx) {
+                if ((bit++ & 7) == 0) {
+                    byte = *bits++;
+                }
+                if (byte & 0x80) {
+                    writePixel(cursor_x + glyph.xOffset + xx, cursor_y + glyph.yOffset + yy, textcolor);
+                }
+                byte <<= 1;
+            }
+        }
+        endWrite();
+        cursor_x += glyph.xAdvance;
+        return 1;
+    }
+
+protected:
+    int16_t _width;
+    int16_t _height;
+    int16_t cursor_x = 0;
+    int16_t cursor_y = 0;
+    uint16_t textcolor = 0xFFFF;
+    GFXfont* gfxFont = nullptr;
+    bool wrap = true;
+};
+
+#endif // HOST_ADAFRUIT_GFX_H
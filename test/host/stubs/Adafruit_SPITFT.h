@@ -0,0 +1,115 @@
+#ifndef HOST_ADAFRUIT_SPITFT_H
+#define HOST_ADAFRUIT_SPITFT_H
+
+#include <Adafruit_GFX.h>
+#include <vector>
+
+// Stands in for the panel. Pixels sent to it land in a model of its frame
+// memory and every pixel sent is counted, so a test can check both what is
+// on screen and how much was pushed over SPI to get it there. The vertical
+// scrolling commands of the ST7789 are modelled too, so shownPixel() gives
+// what the panel displays rather than what is in its memory.
+class Adafruit_SPITFT : public Adafruit_GFX {
+
+public:
+    Adafruit_SPITFT(int16_t w, int16_t h)
+        : Adafruit_GFX(w, h), mRam((size_t)w * h, 0), mScrollHeight(h) {
+        sLastPanel = this;
+    }
+
+    // the panel made last, for a test to look at one it can't reach
+    static inline Adafruit_SPITFT* sLastPanel = nullptr;
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+        if (x >= 0 && y >= 0 && x < _width && y < _height) {
+            mRam[(size_t)y * _width + x] = color;
+        }
+        mBytesSent += 2;
+    }
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override {
+        const int16_t x2 = std::min<int32_t>(x + w, _width);
+        const int16_t y2 = std::min<int32_t>(y + h, _height);
+        x = std::max<int16_t>(x, 0);
+        y = std::max<int16_t>(y, 0);
+        for (int16_t row = y; row < y2; ++row) {
+            for (int16_t col = x; col < x2; ++col) {
+                mRam[(size_t)row * _width + col] = color;
+            }
+        }
+        if (x < x2 && y < y2) {
+            mBytesSent += (uint32_t)(x2 - x) * (y2 - y) * 2;
+        }
+    }
+
+    virtual void setAddrWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+        mWindowX = x;
+        mWindowY = y;
+        mWindowW = w;
+        mWindowH = h;
+        mWindowPos = 0;
+    }
+    // bigEndian pixels are in the panel's byte order, the rest native
+    void writePixels(uint16_t* colors, uint32_t len, bool /*block*/ = true, bool bigEndian = false) {
+        for (uint32_t i = 0; i < len; ++i) {
+            const uint16_t color = bigEndian ? __builtin_bswap16(colors[i]) : colors[i];
+            if (mWindowW > 0 && mWindowH > 0) {
+                const int32_t x = mWindowX + mWindowPos % mWindowW;
+                const int32_t y = mWindowY + (mWindowPos / mWindowW) % mWindowH;
+                if (x < _width && y < _height) {
+                    mRam[(size_t)y * _width + x] = color;
+                }
+            }
+            ++mWindowPos;
+        }
+        mBytesSent += len * 2;
+    }
+    void setSPISpeed(uint32_t) {}
+
+    void sendCommand(uint8_t command, const uint8_t* data = nullptr, uint8_t count = 0) {
+        if (command == 0x33 && count == 6) {        // VSCRDEF
+            mScrollTop = (data[0] << 8) | data[1];
+            mScrollHeight = (data[2] << 8) | data[3];
+            mScrollBottom = (data[4] << 8) | data[5];
+        }
+        else if (command == 0x37 && count == 2) {   // VSCRSADD
+            mScrollStart = (data[0] << 8) | data[1];
+        }
+        mBytesSent += count;
+    }
+
+    // a pixel of frame memory
+    uint16_t ramPixel(int16_t x, int16_t y) const {
+        return mRam[(size_t)y * _width + x];
+    }
+    // a pixel as it is displayed: rows of the scroll area show frame memory
+    // from the scroll start on, wrapping around inside the area
+    uint16_t shownPixel(int16_t x, int16_t y) const {
+        return ramPixel(x, shownRamRow(y));
+    }
+    int shownRamRow(int y) const {
+        if (mScrollHeight <= 0 || y < mScrollTop || y >= mScrollTop + mScrollHeight) {
+            return y;
+        }
+        const int offset = ((mScrollStart - mScrollTop) % mScrollHeight + mScrollHeight) % mScrollHeight;
+        return mScrollTop + (y - mScrollTop + offset) % mScrollHeight;
+    }
+    bool isScrollAreaValid() const {
+        return mScrollTop + mScrollHeight + mScrollBottom == _height;
+    }
+
+    uint32_t mBytesSent = 0;
+    std::vector<uint16_t> mRam;
+    int mScrollTop = 0;
+    int mScrollHeight;
+    int mScrollBottom = 0;
+    int mScrollStart = 0;
+
+private:
+    int32_t mWindowX = 0;
+    int32_t mWindowY = 0;
+    int32_t mWindowW = 0;
+    int32_t mWindowH = 0;
+    uint32_t mWindowPos = 0;
+};
+
+#endif // HOST_ADAFRUIT_SPITFT_H
@@ -0,0 +1,25 @@
+#ifndef HOST_ADAFRUIT_ST7789_H
+#define HOST_ADAFRUIT_ST7789_H
+
+#include <Adafruit_SPITFT.h>
+
+#define ST77XX_BLACK 0x0000
+#define ST77XX_WHITE 0xFFFF
+#define ST77XX_RED 0xF800
+#define ST77XX_GREEN 0x07E0
+#define ST77XX_BLUE 0x001F
+#define ST77XX_CYAN 0x07FF
+#define ST77XX_MAGENTA 0xF81F
+#define ST77XX_YELLOW 0xFFE0
+#define ST77XX_ORANGE 0xFC00
+
+class Adafruit_ST7789 : public Adafruit_SPITFT {
+
+public:
+    Adafruit_ST7789(int8_t, int8_t, int8_t) : Adafruit_SPITFT(240, 320) {}
+
+    void init(uint16_t, uint16_t) {}
+    void setRotation(uint8_t) override {}
+};
+
+#endif // HOST_ADAFRUIT_ST7789_H
@@ -0,0 +1,174 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Just enough of the Arduino core to build the game's sources on a desktop
+// compiler. Time only moves when a test moves it, see host_stubs.h.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdarg>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <algorithm>
+
+#define PROGMEM
+#define F(x) x
+#define IRAM_ATTR
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define ANALOG 3
+
+#define RISING 1
+#define FALLING 2
+#define CHANGE 3
+
+#define DAC1 17
+#define DAC2 18
+#define PIN_DAC1 17
+
+#define DEC 10
+#define HEX 16
+
+typedef uint8_t byte;
+
+struct String : std::string {
+    String() {}
+    String(const char* s) : std::string(s) {}
+    String(const std::string& s) : std::string(s) {}
+    String(char c) : std::string(1, c) {}
+    String(int value, int base = DEC) : std::string(toText(value, base)) {}
+    String(unsigned value, int base = DEC) : std::string(toText(value, base)) {}
+    String(long value, int base = DEC) : std::string(toText(value, base)) {}
+    String(unsigned long value, int base = DEC) : std::string(toText(value, base)) {}
+
+    unsigned length() const {
+        return size();
+    }
+
+private:
+    static std::string toText(long long value, int base) {
+        char text[24];
+        snprintf(text, sizeof(text), base == HEX ? "%llx" : "%lld", value);
+        return text;
+    }
+};
+
+inline String operator+(const String& a, const String& b) {
+    return String(std::string(a) + std::string(b));
+}
+inline String operator+(const String& a, const char* b) {
+    return String(std::string(a) + b);
+}
+inline String operator+(const char* a, const String& b) {
+    return String(a + std::string(b));
+}
+
+struct Print {
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+
+    size_t print(const String& s) {
+        for (char c : s) {
+            write(c);
+        }
+        return s.size();
+    }
+    size_t print(const char* s) {
+        return print(String(s));
+    }
+    size_t print(char c) {
+        return write(c);
+    }
+    size_t print(int value, int base = DEC) {
+        return print(String(value, base));
+    }
+    size_t print(unsigned value, int base = DEC) {
+        return print(String(value, base));
+    }
+    size_t print(long value, int base = DEC) {
+        return print(String(value, base));
+    }
+    size_t print(unsigned long value, int base = DEC) {
+        return print(String(value, base));
+    }
+    size_t print(double value, int digits = 2) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.*f", digits, value);
+        return print(text);
+    }
+    template <typename T>
+    size_t println(T value) {
+        return print(value) + print("\n");
+    }
+    template <typename T>
+    size_t println(T value, int format) {
+        return print(value, format) + print("\n");
+    }
+    size_t println() {
+        return print("\n");
+    }
+    size_t printf(const char* format, ...) {
+        char text[256];
+        va_list args;
+        va_start(args, format);
+        vsnprintf(text, sizeof(text), format, args);
+        va_end(args);
+        return print(text);
+    }
+};
+
+// goes to stdout unless a test turns it off, and can be kept for a test
+// to look through
+struct HWSerial : Print {
+    bool mEcho = true;
+    bool mCapture = false;
+    std::string mCaptured;
+
+    void begin(int) {}
+    size_t write(uint8_t c) override {
+        if (mEcho) {
+            fputc(c, stdout);
+        }
+        if (mCapture) {
+            mCaptured += (char)c;
+        }
+        return 1;
+    }
+    void flush() {
+        fflush(stdout);
+    }
+    int available() {
+        return 0;
+    }
+    int read() {
+        return -1;
+    }
+};
+extern HWSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+long random(long max);
+long random(long min, long max);
+
+void pinMode(int pin, int mode);
+int digitalRead(int pin);
+void digitalWrite(int pin, int level);
+void dacWrite(int pin, uint8_t value);
+
+int digitalPinToInterrupt(int pin);
+void attachInterruptArg(int interrupt, void (*handler)(void*), void* arg, int mode);
+void detachInterrupt(int interrupt);
+
+bool psramFound();
+void* ps_malloc(size_t bytes);
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,39 @@
+#ifndef HOST_DAC_CONTINUOUS_H
+#define HOST_DAC_CONTINUOUS_H
+
+#include <cstdint>
+#include <cstddef>
+#include "esp_timer.h"
+
+typedef struct dac_cont* dac_continuous_handle_t;
+
+typedef enum {
+    DAC_CHANNEL_MASK_CH0 = 1,
+    DAC_CHANNEL_MASK_CH1 = 2,
+    DAC_CHANNEL_MASK_ALL = 3,
+} dac_channel_mask_t;
+typedef enum {
+    DAC_DIGI_CLK_SRC_DEFAULT = 0,
+} dac_continuous_digi_clk_src_t;
+typedef enum {
+    DAC_CHANNEL_MODE_SIMUL,
+    DAC_CHANNEL_MODE_ALTER,
+} dac_continuous_channel_mode_t;
+
+typedef struct {
+    dac_channel_mask_t chan_mask;
+    uint32_t desc_num;
+    size_t buf_size;
+    uint32_t freq_hz;
+    int8_t offset;
+    dac_continuous_digi_clk_src_t clk_src;
+    dac_continuous_channel_mode_t chan_mode;
+} dac_continuous_config_t;
+
+esp_err_t dac_continuous_new_channels(const dac_continuous_config_t* config, dac_continuous_handle_t* handle);
+esp_err_t dac_continuous_del_channels(dac_continuous_handle_t handle);
+esp_err_t dac_continuous_enable(dac_continuous_handle_t handle);
+esp_err_t dac_continuous_disable(dac_continuous_handle_t handle);
+esp_err_t dac_continuous_write(dac_continuous_handle_t handle, uint8_t* data, size_t size, size_t* written, int timeoutMs);
+
+#endif // HOST_DAC_CONTINUOUS_H
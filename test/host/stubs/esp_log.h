@@ -0,0 +1,3 @@
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+#endif // HOST_ESP_LOG_H
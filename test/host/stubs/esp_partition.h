@@ -0,0 +1,29 @@
+#ifndef HOST_ESP_PARTITION_H
+#define HOST_ESP_PARTITION_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int esp_err_t;
+#ifndef ESP_OK
+  #define ESP_OK 0
+#endif
+
+typedef enum {
+    ESP_PARTITION_TYPE_DATA = 1,
+} esp_partition_type_t;
+typedef int esp_partition_subtype_t;
+typedef struct {
+    uint32_t address;
+    uint32_t size;
+} esp_partition_t;
+typedef enum {
+    ESP_PARTITION_MMAP_DATA,
+} esp_partition_mmap_memory_t;
+typedef uint32_t esp_partition_mmap_handle_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype, const char* label);
+esp_err_t esp_partition_mmap(const esp_partition_t* partition, size_t offset, size_t size,
+    esp_partition_mmap_memory_t memory, const void** out, esp_partition_mmap_handle_t* handle);
+
+#endif // HOST_ESP_PARTITION_H
@@ -0,0 +1,3 @@
+#ifndef HOST_ESP_SLEEP_H
+#define HOST_ESP_SLEEP_H
+#endif // HOST_ESP_SLEEP_H
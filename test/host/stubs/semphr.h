@@ -0,0 +1,12 @@
+#ifndef HOST_SEMPHR_H
+#define HOST_SEMPHR_H
+
+#include "FreeRTOS.h"
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateBinary();
+int xSemaphoreTake(SemaphoreHandle_t semaphore, uint32_t ticks);
+int xSemaphoreGive(SemaphoreHandle_t semaphore);
+int xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* woken);
+
+#endif // HOST_SEMPHR_H
@@ -0,0 +1,6 @@
+#ifndef HOST_SOC_CAPS_H
+#define HOST_SOC_CAPS_H
+
+#define SOC_DAC_SUPPORTED 1
+
+#endif // HOST_SOC_CAPS_H
@@ -0,0 +1,198 @@
+// ButtonDebounce over made up edge traces, and InputManager over edges
+// whose interrupts run late or don't fit the queue.
+
+#include "host_stubs.h"
+#include "test_check.h"
+#include "input_manager.h"
+
+static const uint32_t DEBOUNCE_US = 30000;
+static const int UP_PIN = 1;
+static const int DOWN_PIN = 3;
+static const int SELECT_PIN = 7;
+
+struct TraceEdge {
+    uint32_t mTimeUs;
+    int mLevel;
+};
+
+struct TraceResult {
+    int mPresses;
+    int mLevel;
+    uint32_t mFirstPressUs;
+};
+
+// runs a trace through a released button, settling it at endUs
+static TraceResult runTrace(std::initializer_list<TraceEdge> edges, uint32_t endUs, uint32_t startUs = 0) {
+    ButtonDebounce button;
+    button.reset(HIGH, startUs, DEBOUNCE_US);
+    TraceResult result = { 0, HIGH, 0 };
+    for (const TraceEdge& edge : edges) {
+        button.edge(edge.mLevel, edge.mTimeUs, DEBOUNCE_US);
+        if (button.mPresses && result.mPresses == 0) {
+            result.mFirstPressUs = button.mChangedUs;
+        }
+        result.mPresses += button.mPresses;
+        button.mPresses = 0;
+    }
+    button.settle(endUs, DEBOUNCE_US);
+    CHECK(!button.isSettling());
+    result.mPresses += button.mPresses;
+    result.mLevel = button.mLevel;
+    return result;
+}
+
+static void testTraces() {
+    // a press and a release that bounce, each counted on its first edge
+    TraceResult r = runTrace({ { 100000, LOW }, { 100300, HIGH }, { 100700, LOW }, { 101500, HIGH }, { 102000, LOW },
+                               { 250000, HIGH }, { 250400, LOW }, { 251000, HIGH } }, 400000);
+    CHECK_EQ(r.mPresses, 1);
+    CHECK_EQ(r.mLevel, HIGH);
+    CHECK_EQ(r.mFirstPressUs, 100000u);
+
+    // a tap shorter than the debounce time still counts, and is let go
+    // once the debounce time is up
+    r = runTrace({ { 100000, LOW }, { 105000, HIGH } }, 400000);
+    CHECK_EQ(r.mPresses, 1);
+    CHECK_EQ(r.mLevel, HIGH);
+
+    // two presses further apart than the debounce time
+    r = runTrace({ { 100000, LOW }, { 150000, HIGH }, { 200000, LOW }, { 260000, HIGH } }, 400000);
+    CHECK_EQ(r.mPresses, 2);
+
+    // a burst of bounces that ends held down, then a burst on release that
+    // ends up, all inside the debounce time: one press
+    r = runTrace({ { 100000, LOW }, { 100010, HIGH }, { 100020, LOW }, { 100030, HIGH }, { 100040, LOW },
+                   { 100050, HIGH }, { 100060, LOW } }, 400000);
+    CHECK_EQ(r.mPresses, 1);
+    CHECK_EQ(r.mLevel, LOW);
+
+    // across micros() wrapping around
+    r = runTrace({ { 0xFFFFF000u, LOW }, { 0xFFFFF800u, HIGH }, { 0x00001000u, LOW } }, 0x00100000u, 0xFFFF0000u);
+    CHECK_EQ(r.mPresses, 1);
+    CHECK_EQ(r.mLevel, LOW);
+    CHECK_EQ(r.mFirstPressUs, 0xFFFFF000u);
+}
+
+// InputManager with every pin up
+static void setupInput(InputManager& input) {
+    for (int pin : { UP_PIN, DOWN_PIN, SELECT_PIN }) {
+        hostSetPin(pin, HIGH);
+    }
+    input.setup(UP_PIN, DOWN_PIN, SELECT_PIN, DEBOUNCE_US / 1000);
+}
+
+// a pass of the main loop, the presses it reads
+static InputState pass(InputManager& input, uint32_t afterUs) {
+    hostAdvanceTime(afterUs);
+    input.update();
+    return input.ReadInputState();
+}
+
+static void testLateInterrupts() {
+    InputManager input;
+    setupInput(input);
+
+    // a glitch gone before either of its interrupts ran reads up twice,
+    // and is nothing
+    hostSetPinQuietly(SELECT_PIN, LOW);
+    hostSetPinQuietly(SELECT_PIN, HIGH);
+    hostFirePin(SELECT_PIN);
+    hostFirePin(SELECT_PIN);
+    InputState state = pass(input, 1000);
+    CHECK(!state.isAnyPressed());
+    CHECK_EQ(input.nextUpdateIn(), -1);
+
+    // a bouncing press whose interrupts all run once it has settled down
+    hostSetPinQuietly(SELECT_PIN, LOW);
+    hostSetPinQuietly(SELECT_PIN, HIGH);
+    hostSetPinQuietly(SELECT_PIN, LOW);
+    hostAdvanceTime(200);
+    hostFirePin(SELECT_PIN);
+    hostFirePin(SELECT_PIN);
+    hostFirePin(SELECT_PIN);
+    state = pass(input, 1000);
+    CHECK_EQ(state.getCount(Button::Select), 1);
+
+    // a release whose first interrupt read the pin bounced back down is
+    // let go on the next, which reads it up
+    hostAdvanceTime(100000);
+    hostSetPinQuietly(SELECT_PIN, HIGH);
+    hostSetPinQuietly(SELECT_PIN, LOW);
+    hostFirePin(SELECT_PIN);
+    hostSetPinQuietly(SELECT_PIN, HIGH);
+    hostFirePin(SELECT_PIN);
+    state = pass(input, 1000);
+    CHECK(!state.isAnyPressed());
+    CHECK_EQ(input.mButton[Button::Select].mDebounce.mLevel, HIGH);
+    CHECK_EQ(input.nextUpdateIn(), -1);
+
+    // Up then Down pressed, with Down's interrupt running first: each is
+    // debounced on its own, so both count once
+    hostAdvanceTime(100000);
+    hostSetPinQuietly(UP_PIN, LOW);
+    hostAdvanceTime(50);
+    hostSetPin(DOWN_PIN, LOW);
+    hostFirePin(UP_PIN);
+    hostSetPin(UP_PIN, HIGH);
+    hostSetPin(UP_PIN, LOW);
+    state = pass(input, 1000);
+    CHECK_EQ(state.getCount(Button::Up), 1);
+    CHECK_EQ(state.getCount(Button::Down), 1);
+    hostSetPin(UP_PIN, HIGH);
+    hostSetPin(DOWN_PIN, HIGH);
+    state = pass(input, 100000);
+    CHECK(!state.isAnyPressed());
+}
+
+static void testOverflow() {
+    InputManager input;
+    setupInput(input);
+
+    // 20 taps of Up and no update() in between: the first 16 fit the
+    // queue of 32 edges and count, the rest are dropped
+    for (int tap = 0; tap < 20; ++tap) {
+        hostAdvanceTime(40000);
+        hostSetPin(UP_PIN, LOW);
+        hostAdvanceTime(40000);
+        hostSetPin(UP_PIN, HIGH);
+    }
+    InputState state = pass(input, 1000);
+    CHECK_EQ(state.getCount(Button::Up), 16);
+    CHECK_EQ(input.mButton[Button::Up].mDebounce.mLevel, HIGH);
+    CHECK_EQ(input.nextUpdateIn(), -1);
+
+    // again, but left held down: the press whose edge was dropped is
+    // taken from the pin itself
+    for (int tap = 0; tap < 20; ++tap) {
+        hostAdvanceTime(40000);
+        hostSetPin(SELECT_PIN, LOW);
+        hostAdvanceTime(40000);
+        hostSetPin(SELECT_PIN, HIGH);
+    }
+    hostAdvanceTime(40000);
+    hostSetPin(SELECT_PIN, LOW);
+    input.update();
+    CHECK_EQ(input.mButton[Button::Select].mDebounce.mPresses, 17);
+    CHECK_EQ(input.mButton[Button::Select].mDebounce.mLevel, LOW);
+    // Select is read a press at a time
+    state = input.ReadInputState();
+    CHECK_EQ(state.getCount(Button::Select), 1);
+
+    // the queue works again afterwards
+    input.clear();
+    hostSetPin(SELECT_PIN, HIGH);
+    state = pass(input, 100000);
+    hostSetPin(DOWN_PIN, LOW);
+    state = pass(input, 1000);
+    CHECK_EQ(state.getCount(Button::Down), 1);
+    hostSetPin(DOWN_PIN, HIGH);
+}
+
+int main() {
+    Serial.mEcho = false;
+    hostSetTime(1000000);
+    testTraces();
+    testLateInterrupts();
+    testOverflow();
+    return testResult("test_button_debounce");
+}
@@ -0,0 +1,34 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <cstdio>
+
+// Each test is a plain program: CHECK() prints what failed and carries
+// on, and main() returns testResult() so make stops on a failing test.
+
+static int sTestFailures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            ++sTestFailures; \
+        } \
+    } while (0)
+
+#define CHECK_EQ(a, b) \
+    do { \
+        const long long checkA = (long long)(a); \
+        const long long checkB = (long long)(b); \
+        if (checkA != checkB) { \
+            printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, checkA, checkB); \
+            ++sTestFailures; \
+        } \
+    } while (0)
+
+static inline int testResult(const char* name) {
+    printf("%s: %s\n", name, sTestFailures == 0 ? "passed" : "FAILED");
+    return sTestFailures == 0 ? 0 : 1;
+}
+
+#endif // TEST_CHECK_H
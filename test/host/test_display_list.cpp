@@ -0,0 +1,186 @@
+// Compiling a layout into a display list: where its ops land, and what a
+// change of screen or selection leaves to be drawn.
+
+#include <cctype>
+#include <string>
+#include "host_stubs.h"
+#include "test_check.h"
+#include "display_list.h"
+#include "display_manager.h"
+#include "assets/SerifGothicStd_Bold12pt7b.h"
+#include "assets/SerifGothicStd_Bold20pt7b.h"
+
+static ScreenLayout makeLayout(const char* gold, int options, int selection) {
+    ScreenLayout layout;
+    layout.mTitle = "Bazaar";
+    layout.addInfo("Warriors 10", ST77XX_WHITE);
+    layout.addInfo(gold, ST77XX_YELLOW);
+    for (int i = 0; i < options; ++i) {
+        layout.addOption(String("Option ") + String(i), i);
+    }
+    layout.mSelection = selection;
+    return layout;
+}
+
+static DisplayList compile(const ScreenLayout& layout) {
+    DisplayList list;
+    list.compile(layout, &SerifGothicStd_Bold20pt7b, &SerifGothicStd_Bold12pt7b);
+    return list;
+}
+
+static int16_t centered(const char* text, const GFXfont* font) {
+    return 120 - (DisplayManager::measureText(text, font) >> 1);
+}
+
+static void testCompile() {
+    const DisplayList list = compile(makeLayout("Gold 30", 3, 1));
+    const std::vector<DrawOp>& ops = list.getOps();
+    CHECK_EQ(ops.size(), 6);
+    CHECK_EQ(list.getScrollHeight(), 0);
+
+    // no bitmap, so the title owns the gap below it
+    CHECK_EQ(ops[0].mType, DrawOp::Title);
+    CHECK_EQ(ops[0].mX, centered("Bazaar", &SerifGothicStd_Bold20pt7b));
+    CHECK_EQ(ops[0].mY, 27);
+    CHECK_EQ(ops[0].mTop, 0);
+    CHECK_EQ(ops[0].mBottom, 48);
+
+    CHECK_EQ(ops[1].mType, DrawOp::Text);
+    CHECK_EQ(ops[1].mY, 69);
+    CHECK_EQ(ops[1].mTop, 52);
+    CHECK_EQ(ops[1].mBottom, 75);
+    CHECK_EQ(ops[2].mY, 92);
+    CHECK_EQ(ops[2].mColor, ST77XX_YELLOW);
+
+    // three options centred in the nine rows left, none selected yet
+    for (int i = 0; i < 3; ++i) {
+        const DrawOp& op = ops[3 + i];
+        CHECK_EQ(op.mType, DrawOp::Option);
+        CHECK_EQ(op.mIndex, i);
+        CHECK_EQ(op.mX, centered("Option 0", &SerifGothicStd_Bold12pt7b));
+        CHECK_EQ(op.mY, 188 + i * SMALL_LINE_HEIGHT);
+        CHECK_EQ(op.mTop, 171 + i * SMALL_LINE_HEIGHT);
+        CHECK_EQ(op.mBottom, op.mTop + SMALL_LINE_HEIGHT);
+        CHECK_EQ(op.mColor, ST77XX_WHITE);
+        CHECK_EQ(op.mFlags, 0);
+    }
+
+    Serial.mCapture = true;
+    Serial.mCaptured.clear();
+    list.dump(Serial);
+    Serial.mCapture = false;
+    // hex digits are upper case on the board and lower case here
+    std::string dump = Serial.mCaptured;
+    for (char& c : dump) {
+        c = tolower(c);
+    }
+    CHECK(dump.find("display list: 6 ops, 3 option rows\n") == 0);
+    CHECK(dump.find("\ntitle x=" + std::to_string(ops[0].mX) + " y=27 rows=0-48 color=0xffff \"bazaar\"\n") != std::string::npos);
+    CHECK(dump.find(" y=92 rows=75-98 color=0xffe0 \"gold 30\"\n") != std::string::npos);
+    CHECK(dump.find(" y=234 rows=217-240 color=0xffff \"option 2\"\n") != std::string::npos);
+    CHECK(dump.find("selected") == std::string::npos);
+
+    // the selection is only applied when the ops are placed
+    std::vector<DrawOp> placed;
+    list.place(1, 0, placed);
+    CHECK_EQ(placed.size(), 6);
+    CHECK_EQ(placed[4].mColor, ST77XX_YELLOW);
+    CHECK_EQ(placed[4].mFlags, DrawOp::Selected);
+    CHECK_EQ(placed[3].mColor, ST77XX_WHITE);
+    CHECK_EQ(placed[5].mTop, ops[5].mTop);
+
+    CHECK(list.matches(makeLayout("Gold 30", 3, 0)));
+    CHECK(list.matches(makeLayout("Gold 30", 3, 2)));
+    CHECK(!list.matches(makeLayout("Gold 31", 3, 1)));
+    CHECK(!list.matches(makeLayout("Gold 30", 4, 1)));
+    CHECK(!DisplayList().matches(ScreenLayout()));
+}
+
+static void testLongList() {
+    const DisplayList list = compile(makeLayout("Gold 30", 14, 0));
+    const std::vector<DrawOp>& ops = list.getOps();
+    CHECK_EQ(ops.size(), 3 + 14);
+    CHECK(list.getScrollHeight() > 0);
+    CHECK_EQ(list.getScrollTop(), ops[3].mTop);
+    const int rows = list.getScrollHeight() / SMALL_LINE_HEIGHT;
+    CHECK(rows < 14);
+
+    // the window only moves once the selection reaches its last row
+    CHECK_EQ(list.placeStartLine(rows - 2, 0), 0);
+    CHECK_EQ(list.placeStartLine(rows - 1, 0), 1);
+    CHECK_EQ(list.placeStartLine(13, 0), 14 - rows);
+    CHECK_EQ(list.placeStartLine(5, 3), 3);
+    CHECK_EQ(list.placeStartLine(0, 3), 0);
+
+    // placed options start from the top of the scroll area
+    std::vector<DrawOp> placed;
+    const int start = 14 - rows;
+    list.place(13, start, placed);
+    CHECK_EQ(placed.size(), 3 + rows);
+    CHECK_EQ(placed[3].mIndex, start);
+    CHECK_EQ(placed[3].mTop, list.getScrollTop());
+    CHECK_EQ(placed.back().mIndex, 13);
+    CHECK_EQ(placed.back().mBottom, list.getScrollTop() + list.getScrollHeight());
+    CHECK_EQ(placed.back().mFlags, DrawOp::Selected);
+
+    DrawOp op;
+    CHECK(!list.placeOption(start - 1, 13, start, op));
+    CHECK(list.placeOption(start, 13, start, op));
+    CHECK_EQ(op.mY, placed[3].mY);
+}
+
+static void testDelta() {
+    const DisplayList shown = compile(makeLayout("Gold 30", 3, 0));
+    std::vector<DrawOp> shownOps;
+    shown.place(0, 0, shownOps);
+
+    // moving the selection down recolors the two options involved
+    std::vector<DrawOp> ops;
+    shown.place(1, 0, ops);
+    FrameDelta delta;
+    shown.diff(shown, shownOps, ops, delta);
+    CHECK_EQ(delta.mActions[0], FrameDelta::Keep);
+    CHECK_EQ(delta.mActions[1], FrameDelta::Keep);
+    CHECK_EQ(delta.mActions[2], FrameDelta::Keep);
+    CHECK_EQ(delta.mActions[3], FrameDelta::Unselect);
+    CHECK_EQ(delta.mActions[4], FrameDelta::Recolor);
+    CHECK_EQ(delta.mActions[5], FrameDelta::Keep);
+    for (size_t i = 0; i < shownOps.size(); ++i) {
+        CHECK(delta.mReused[i]);
+    }
+
+    // new text in the same place is drawn again, the rest stays
+    const DisplayList next = compile(makeLayout("Gold 45", 3, 0));
+    next.place(0, 0, ops);
+    next.diff(shown, shownOps, ops, delta);
+    CHECK_EQ(delta.mActions[1], FrameDelta::Keep);
+    CHECK_EQ(delta.mActions[2], FrameDelta::Draw);
+    CHECK(!delta.mReused[2]);
+    CHECK_EQ(delta.mActions[3], FrameDelta::Keep);
+
+    // a line in a new color is only drawn over
+    ScreenLayout warned = makeLayout("Gold 30", 3, 0);
+    warned.mTextLines[0].mValue = ST77XX_RED;
+    const DisplayList recolored = compile(warned);
+    recolored.place(0, 0, ops);
+    recolored.diff(shown, shownOps, ops, delta);
+    CHECK_EQ(delta.mActions[1], FrameDelta::Recolor);
+    CHECK(delta.mReused[1]);
+
+    // a fourth option moves the others up a row, so they are all drawn
+    const DisplayList longer = compile(makeLayout("Gold 30", 4, 0));
+    longer.place(0, 0, ops);
+    longer.diff(shown, shownOps, ops, delta);
+    CHECK_EQ(delta.mActions[0], FrameDelta::Keep);
+    for (size_t j = 3; j < ops.size(); ++j) {
+        CHECK_EQ(delta.mActions[j], FrameDelta::Draw);
+    }
+}
+
+int main() {
+    Serial.mEcho = false;
+    testCompile();
+    testLongList();
+    testDelta();
+    return testResult("test_display_list");
+}
@@ -0,0 +1,111 @@
+// How much the canvas pushes to the panel: a whole new screen against a
+// change to one line of text.
+
+#include "host_stubs.h"
+#include "test_check.h"
+#include "display_manager.h"
+
+static const uint32_t FULL_FRAME_BYTES = CANVAS_WIDTH * CANVAS_HEIGHT * 2;
+static const uint32_t TILE_ROW_BYTES = CANVAS_WIDTH * CANVAS_TILE_SIZE * 2;
+
+static bool sameRam(const Adafruit_SPITFT& a, const Adafruit_SPITFT& b) {
+    return a.mRam == b.mRam;
+}
+
+static void testCanvasFlush() {
+    Adafruit_ST7789 panel(0, 0, 0);
+    FrameCanvas canvas;
+    CHECK(canvas.begin());
+
+    // every tile differs from the black the panel starts with
+    canvas.fillScreen(ST77XX_BLUE);
+    CHECK_EQ(canvas.flush(panel), FULL_FRAME_BYTES);
+    CHECK_EQ(panel.mBytesSent, FULL_FRAME_BYTES);
+    CHECK_EQ(panel.ramPixel(239, 319), ST77XX_BLUE);
+
+    // a line of text 23 rows high from y 100 covers tile rows 6 and 7
+    panel.mBytesSent = 0;
+    canvas.fillRect(0, 100, 240, 23, ST77XX_WHITE);
+    CHECK_EQ(canvas.flush(panel), 2 * TILE_ROW_BYTES);
+    CHECK_EQ(panel.mBytesSent, 2 * TILE_ROW_BYTES);
+    CHECK_EQ(panel.ramPixel(0, 99), ST77XX_BLUE);
+    CHECK_EQ(panel.ramPixel(0, 100), ST77XX_WHITE);
+
+    // drawing the same pixels again sends nothing
+    panel.mBytesSent = 0;
+    canvas.fillRect(0, 100, 240, 23, ST77XX_WHITE);
+    CHECK_EQ(canvas.flush(panel), 0);
+    CHECK_EQ(panel.mBytesSent, 0);
+
+    // one word only sends the tiles it falls in
+    canvas.fillRect(40, 100, 20, 10, ST77XX_RED);
+    CHECK_EQ(canvas.flush(panel), 2 * CANVAS_TILE_SIZE * CANVAS_TILE_SIZE * 2);
+}
+
+static ScreenLayout makeLayout(const char* secondLine) {
+    ScreenLayout layout;
+    layout.mTitle = "Dark Tower";
+    layout.addInfo("Warriors 10", ST77XX_WHITE);
+    layout.addInfo(secondLine, ST77XX_WHITE);
+    layout.addInfo("Food 25", ST77XX_WHITE);
+    layout.addOption("Continue", 0);
+    layout.addOption("Back", 1);
+    return layout;
+}
+
+static void testDisplayManagerFlush() {
+    DisplayManager display;
+    display.setup();
+    Adafruit_SPITFT& panel = *Adafruit_SPITFT::sLastPanel;
+    CHECK(display.isUsingCanvas());
+
+    display.setDesiredLayout(makeLayout("Gold 30"));
+    display.repaint();
+    const uint32_t fullBytes = display.getLastFlushBytes();
+    printf("new screen: %u bytes flushed\n", fullBytes);
+    CHECK(fullBytes > 4 * TILE_ROW_BYTES);
+
+    // only the changed line's band is redrawn, which is at most the two
+    // tile rows it straddles
+    panel.mBytesSent = 0;
+    display.setDesiredLayout(makeLayout("Gold 31"));
+    display.repaint();
+    const uint32_t lineBytes = display.getLastFlushBytes();
+    printf("one line changed: %u bytes flushed\n", lineBytes);
+    CHECK(lineBytes > 0);
+    CHECK(lineBytes <= 2 * TILE_ROW_BYTES);
+    CHECK_EQ(panel.mBytesSent, lineBytes);
+
+    // and the panel ends up as it would have from a full repaint
+    DisplayManager fresh;
+    fresh.setup();
+    fresh.setDesiredLayout(makeLayout("Gold 31"));
+    fresh.repaint();
+    CHECK(sameRam(panel, *Adafruit_SPITFT::sLastPanel));
+
+    // nothing changed, nothing is sent
+    panel.mBytesSent = 0;
+    display.forceRepaint();
+    display.repaint();
+    CHECK_EQ(display.getLastFlushBytes(), 0);
+    CHECK_EQ(panel.mBytesSent, 0);
+
+    // a screen compiled ahead of time changes nothing until it is shown,
+    // and is then shown as it would have been
+    display.prepare(makeLayout("Gold 40"));
+    display.repaint();
+    CHECK_EQ(panel.mBytesSent, 0);
+    CHECK(display.getState() == makeLayout("Gold 31"));
+    display.setDesiredLayout(makeLayout("Gold 40"));
+    display.repaint();
+    fresh.setDesiredLayout(makeLayout("Gold 40"));
+    fresh.repaint();
+    CHECK(sameRam(panel, *Adafruit_SPITFT::sLastPanel));
+}
+
+int main() {
+    Serial.mEcho = false;
+    testCanvasFlush();
+    testDisplayManagerFlush();
+    return testResult("test_frame_canvas");
+}
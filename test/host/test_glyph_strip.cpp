@@ -0,0 +1,77 @@
+// Text sent to the panel as one burst: it matches what Adafruit_GFX would
+// have drawn, and stays inside the rows its op owns.
+
+#include <vector>
+#include "host_stubs.h"
+#include "test_check.h"
+#include "display_manager.h"
+#include "assets/SerifGothicStd_Bold20pt7b.h"
+
+static const uint16_t TILE_COLOR = ST77XX_GREEN;
+
+// a raw tile of one color, stored big-endian as the codec expects
+static TileBitmap makeTile(std::vector<uint8_t>& data) {
+    data.clear();
+    for (int i = 0; i < 120 * 90; ++i) {
+        data.push_back(TILE_COLOR >> 8);
+        data.push_back(TILE_COLOR & 0xFF);
+    }
+    TileBitmap tile = {120, 90, (uint32_t)data.size(), data.data(), TileCodec::Raw};
+    return tile;
+}
+
+static ScreenLayout makeLayout(const char* title, const TileBitmap* tile) {
+    ScreenLayout layout;
+    layout.mTitle = title;
+    layout.mBitmap = tile;
+    layout.addInfo("Warriors 10", ST77XX_WHITE);
+    return layout;
+}
+
+int main() {
+    Serial.mEcho = false;
+    std::vector<uint8_t> data;
+    const TileBitmap tile = makeTile(data);
+
+    DisplayManager display;
+    display.setup();
+    Adafruit_SPITFT& panel = *Adafruit_SPITFT::sLastPanel;
+    CHECK(!display.isUsingCanvas());
+
+    display.setDesiredLayout(makeLayout("Dungeon", &tile));
+    display.repaint();
+    CHECK_EQ(panel.ramPixel(0, 32), TILE_COLOR);
+
+    // a new title with descenders is redrawn on its own, as the bitmap
+    // under it hasn't changed, and must not blank the bitmap's top rows
+    const uint32_t before = panel.mBytesSent;
+    display.setDesiredLayout(makeLayout("Gypsy", &tile));
+    display.repaint();
+    CHECK(panel.mBytesSent - before < 240 * 32 * 2 * 2);
+    int blanked = 0;
+    for (int y = 32; y < 48; ++y) {
+        for (int x = 0; x < 240; ++x) {
+            blanked += panel.ramPixel(x, y) != TILE_COLOR;
+        }
+    }
+    CHECK_EQ(blanked, 0);
+
+    // inside the title's rows the burst is what printing it would show
+    Adafruit_ST7789 reference(0, 0, 0);
+    reference.setFont(&SerifGothicStd_Bold20pt7b);
+    reference.setCursor(120 - (DisplayManager::measureText("Gypsy", &SerifGothicStd_Bold20pt7b) >> 1), 27);
+    reference.setTextColor(ST77XX_WHITE);
+    reference.print("Gypsy");
+    int differ = 0;
+    int lit = 0;
+    for (int y = 0; y < 32; ++y) {
+        for (int x = 0; x < 240; ++x) {
+            differ += panel.ramPixel(x, y) != reference.ramPixel(x, y);
+            lit += panel.ramPixel(x, y) == ST77XX_WHITE;
+        }
+    }
+    CHECK_EQ(differ, 0);
+    CHECK(lit > 100);
+
+    return testResult("test_glyph_strip");
+}
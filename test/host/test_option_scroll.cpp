@@ -0,0 +1,140 @@
+// Scrolling a long option list with the panel's vertical scroll registers:
+// what the panel shows must be what a full repaint of the same layout
+// would, whichever way the list got there.
+
+#include "host_stubs.h"
+#include "test_check.h"
+#include "display_manager.h"
+
+static const int OPTION_COUNT = 14;
+
+static ScreenLayout makeLayout(int selection) {
+    ScreenLayout layout;
+    layout.mTitle = "Bazaar";
+    layout.addInfo("Gold 30", ST77XX_WHITE);
+    for (int i = 0; i < OPTION_COUNT; ++i) {
+        layout.addOption(String("Option ") + String(i), i);
+    }
+    layout.mSelection = selection;
+    return layout;
+}
+
+static ScreenLayout makeShortLayout() {
+    ScreenLayout layout;
+    layout.mTitle = "Citadel";
+    layout.addInfo("Warriors 10", ST77XX_WHITE);
+    layout.addOption("Continue", 0);
+    return layout;
+}
+
+// rows of the display that differ from the reference panel's
+static int differingRows(const Adafruit_SPITFT& panel, const Adafruit_SPITFT& reference) {
+    int rows = 0;
+    for (int y = 0; y < 320; ++y) {
+        for (int x = 0; x < 240; ++x) {
+            if (panel.shownPixel(x, y) != reference.shownPixel(x, y)) {
+                ++rows;
+                break;
+            }
+        }
+    }
+    return rows;
+}
+
+// Goes through the same screens, but repaints each one in full from a
+// black panel with no scrolling. The list keeps its start line from the
+// screen before, as it does when scrolled, so both show the same options.
+class Reference {
+
+public:
+    Reference() {
+        mDisplay.setup();
+        mPanel = Adafruit_SPITFT::sLastPanel;
+    }
+
+    const Adafruit_SPITFT& show(const ScreenLayout& layout) {
+        mDisplay.setDesiredLayout(layout);
+        mDisplay.forceRepaint();
+        mDisplay.repaint();
+        return *mPanel;
+    }
+
+private:
+    DisplayManager mDisplay;
+    Adafruit_SPITFT* mPanel;
+};
+
+static bool isScrolled(const Adafruit_SPITFT& panel) {
+    for (int y = 0; y < 320; ++y) {
+        if (panel.shownRamRow(y) != y) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main() {
+    Serial.mEcho = false;
+
+    Reference reference;
+    DisplayManager display;
+    display.setup();
+    Adafruit_SPITFT& panel = *Adafruit_SPITFT::sLastPanel;
+
+    display.setDesiredLayout(makeLayout(0));
+    display.repaint();
+    CHECK(panel.isScrollAreaValid());
+    CHECK(panel.mScrollHeight > 0 && panel.mScrollHeight < 320);
+    CHECK(panel.mScrollHeight % SMALL_LINE_HEIGHT == 0);
+    CHECK(!isScrolled(panel));
+    CHECK_EQ(differingRows(panel, reference.show(makeLayout(0))), 0);
+
+    // walk down one at a time, past the end of the list: the window
+    // scrolls in hardware and only a row or two is sent each step
+    bool scrolled = false;
+    for (int selection = 1; selection < OPTION_COUNT + 3; ++selection) {
+        const uint32_t before = panel.mBytesSent;
+        display.setSelection(selection);
+        display.repaint();
+        const int shown = std::min(selection, OPTION_COUNT - 1);
+        CHECK_EQ(display.getSelection(), shown);
+        CHECK_EQ(differingRows(panel, reference.show(makeLayout(shown))), 0);
+        CHECK(panel.mBytesSent - before <= 3 * 240 * SMALL_LINE_HEIGHT * 2);
+        scrolled |= isScrolled(panel);
+    }
+    CHECK(scrolled);
+    CHECK(isScrolled(panel));
+
+    // and back up to the top, where the offset comes back round to zero
+    for (int selection = OPTION_COUNT - 2; selection >= 0; --selection) {
+        display.setSelection(selection);
+        display.repaint();
+        CHECK_EQ(differingRows(panel, reference.show(makeLayout(selection))), 0);
+    }
+    CHECK(!isScrolled(panel));
+
+    // a jump too far to scroll is redrawn instead
+    display.setSelection(OPTION_COUNT - 1);
+    display.repaint();
+    CHECK_EQ(differingRows(panel, reference.show(makeLayout(OPTION_COUNT - 1))), 0);
+
+    // leaving a scrolled list puts the panel's rows back in order
+    display.setSelection(OPTION_COUNT - 2);
+    display.repaint();
+    CHECK(isScrolled(panel));
+    display.setDesiredLayout(makeShortLayout());
+    display.repaint();
+    CHECK(!isScrolled(panel));
+    CHECK_EQ(differingRows(panel, reference.show(makeShortLayout())), 0);
+
+    // and coming back to it starts from a fresh scroll area
+    display.setDesiredLayout(makeLayout(OPTION_COUNT - 2));
+    display.repaint();
+    CHECK(panel.isScrollAreaValid());
+    CHECK_EQ(differingRows(panel, reference.show(makeLayout(OPTION_COUNT - 2))), 0);
+    display.setSelection(OPTION_COUNT - 1);
+    display.repaint();
+    CHECK_EQ(differingRows(panel, reference.show(makeLayout(OPTION_COUNT - 1))), 0);
+
+    return testResult("test_option_scroll");
+}
@@ -0,0 +1,108 @@
+// Screen task frames: taken from the pool and given back, and never from
+// the heap. Running out of frames, or a frame too big for one, aborts with
+// the size, which is checked in a child process.
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <csignal>
+#include "host_stubs.h"
+#include "test_check.h"
+#include "screen_task.h"
+
+static int sSteps = 0;
+
+static ScreenTask waitTwice() {
+    ScreenTask::Await wait;
+    wait.mWait = ScreenWait::Time;
+    co_await wait;
+    ++sSteps;
+    co_await wait;
+    ++sSteps;
+}
+
+// keeps more than a pool frame alive across the co_await
+static ScreenTask waitWithBigFrame() {
+    volatile uint8_t big[SCREEN_TASK_FRAME_SIZE] = {};
+    ScreenTask::Await wait;
+    wait.mWait = ScreenWait::Time;
+    co_await wait;
+    big[0] = big[SCREEN_TASK_FRAME_SIZE - 1] + 1;
+    sSteps += big[0];
+}
+
+static void runOut(ScreenTask& task) {
+    while (!task.isDone()) {
+        task.resume();
+    }
+}
+
+// runs fn in a child, true if it aborted having printed expected
+static bool aborts(void (*fn)(), const char* expected) {
+    int out[2];
+    if (pipe(out) != 0) {
+        return false;
+    }
+    fflush(stdout);
+    const pid_t child = fork();
+    if (child == 0) {
+        dup2(out[1], STDOUT_FILENO);
+        close(out[0]);
+        Serial.mEcho = true;
+        fn();
+        _exit(0);
+    }
+    close(out[1]);
+    std::string printed;
+    char buffer[256];
+    ssize_t length;
+    while ((length = read(out[0], buffer, sizeof(buffer))) > 0) {
+        printed.append(buffer, length);
+    }
+    close(out[0]);
+    int status = 0;
+    waitpid(child, &status, 0);
+    return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT && printed.find(expected) != std::string::npos;
+}
+
+static void takeOneTooMany() {
+    ScreenTask tasks[SCREEN_TASK_FRAMES + 1];
+    for (ScreenTask& task : tasks) {
+        task = waitTwice();
+    }
+}
+
+static void takeTooBig() {
+    ScreenTask big = waitWithBigFrame();
+}
+
+int main() {
+    Serial.mEcho = false;
+
+    {
+        ScreenTask tasks[SCREEN_TASK_FRAMES];
+        for (ScreenTask& task : tasks) {
+            task = waitTwice();
+            task.resume();
+            CHECK(task.getWait() == ScreenWait::Time);
+        }
+        CHECK_EQ(ScreenTask::getFramesInUse(), SCREEN_TASK_FRAMES);
+        sSteps = 0;
+        for (ScreenTask& task : tasks) {
+            runOut(task);
+        }
+        CHECK_EQ(sSteps, 2 * SCREEN_TASK_FRAMES);
+        CHECK_EQ(ScreenTask::getFramesInUse(), SCREEN_TASK_FRAMES);
+    }
+    // frames go back as the tasks go
+    CHECK_EQ(ScreenTask::getFramesInUse(), 0);
+    ScreenTask again = waitTwice();
+    CHECK_EQ(ScreenTask::getFramesInUse(), 1);
+    again = ScreenTask();
+    CHECK_EQ(ScreenTask::getFramesInUse(), 0);
+
+    CHECK(aborts(takeOneTooMany, "Screen task frames all used"));
+    CHECK(aborts(takeTooBig, "Screen task frame too big"));
+    CHECK_EQ(ScreenTask::getFramesInUse(), 0);
+
+    return testResult("test_screen_task");
+}
@@ -0,0 +1,78 @@
+// The timer path stops ticking through long silences. A sound played just
+// as it decides to stop must still start right away, not once the silence
+// is over.
+
+#include "host_stubs.h"
+#include "test_check.h"
+#include "sound_manager.h"
+
+static uint8_t sSamples[64];
+static const SoundRun sGap[] = { { 16, 8000 } };
+static SoundManager sSound;
+static esp_timer_handle_t sAudioTimer;
+static SoundFile sBlip;
+static SoundHandle sLatePlay = 0;
+
+// play() from the game side, after the audio side has taken its commands
+// but before its timer has stopped
+static void playBeforeStop(esp_timer_handle_t timer, void*) {
+    if (timer == sAudioTimer && sLatePlay == 0) {
+        sLatePlay = sSound.play(sBlip, false);
+    }
+}
+
+int main() {
+    Serial.mEcho = false;
+    memset(sSamples, 200, sizeof(sSamples));
+    sBlip = { sizeof(sSamples), sSamples };
+    // 16 samples, a second of silence, and the rest
+    SoundFile gappy = { 16 + 8000 + 48, sSamples };
+    gappy.silence = sGap;
+    gappy.silenceCount = 1;
+
+    sSound.setup(DAC1);
+    CHECK(!sSound.isUsingDma());
+    sAudioTimer = hostFindTimer("audioPlayer");
+    esp_timer_handle_t wakeTimer = hostFindTimer("audioWake");
+
+    // plays up to the gap, then parks
+    sSound.play(gappy, false);
+    int ticks = 0;
+    while (hostFireTimer(sAudioTimer) && ticks < 1000) {
+        hostAdvanceTime(SOUND_SAMPLE_PERIOD_US);
+        ++ticks;
+    }
+    CHECK_EQ(sSound.getParkCount(), 1);
+    CHECK(esp_timer_is_active(wakeTimer));
+
+    // the wake timer brings it back at the end of the gap, and it parks
+    // again, this time with a sound played as it stops
+    hostAdvanceTime(8000 * SOUND_SAMPLE_PERIOD_US);
+    CHECK(hostFireTimer(wakeTimer));
+    hostBeforeTimerStop(playBeforeStop, nullptr);
+    SoundFile gappyAgain = gappy;
+    sSound.play(gappyAgain, false);
+    ticks = 0;
+    while (sSound.getParkCount() < 2 && hostFireTimer(sAudioTimer) && ticks < 1000) {
+        hostAdvanceTime(SOUND_SAMPLE_PERIOD_US);
+        ++ticks;
+    }
+    hostBeforeTimerStop(nullptr, nullptr);
+    CHECK_EQ(sSound.getParkCount(), 2);
+    CHECK(sLatePlay != 0);
+
+    // the timer is ticking again for the late sound, so it plays out in
+    // its own length, not after the gap
+    CHECK(esp_timer_is_active(sAudioTimer));
+    ticks = 0;
+    while (!sSound.isFinished(sLatePlay) && ticks < 2000) {
+        hostFireTimer(sAudioTimer);
+        hostAdvanceTime(SOUND_SAMPLE_PERIOD_US);
+        sSound.update();
+        ++ticks;
+    }
+    CHECK(sSound.isFinished(sLatePlay));
+    CHECK(ticks < 200);
+
+    return testResult("test_sound_park");
+}
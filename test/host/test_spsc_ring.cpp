@@ -0,0 +1,173 @@
+// The lock-free rings between the game and the audio side, pushed from
+// one thread and popped from another: nothing is lost, repeated, torn or
+// reordered, including across the wrap of the indices and while full. And
+// the sound manager still finishes every sound when its event ring
+// overflows.
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "host_stubs.h"
+#include "test_check.h"
+#include "spsc_ring.h"
+#include "sound_manager.h"
+
+struct Item {
+    uint32_t mSequence;
+    uint32_t mCheck;
+};
+
+static void testFullAndEmpty(uint32_t start) {
+    SpscRing<Item, 8> ring(start);
+    Item item = {};
+    CHECK(ring.empty());
+    CHECK(!ring.pop(item));
+
+    // eight fit, the ninth doesn't, and they come out in order, twice over
+    // so the slots are reused
+    for (uint32_t pass = 0; pass < 2; ++pass) {
+        for (uint32_t i = 0; i < 8; ++i) {
+            CHECK(ring.push({i, ~i}));
+        }
+        CHECK(!ring.push({8, ~8u}));
+        CHECK(!ring.empty());
+        for (uint32_t i = 0; i < 8; ++i) {
+            CHECK(ring.pop(item));
+            CHECK_EQ(item.mSequence, i);
+        }
+        CHECK(!ring.pop(item));
+        CHECK(ring.empty());
+    }
+}
+
+// one thread pushes count items as fast as it can, the other pops them
+template <uint32_t SIZE>
+static void testTwoThreads(uint32_t start, uint32_t count) {
+    SpscRing<Item, SIZE> ring(start);
+    std::atomic<uint32_t> fullCount{0};
+    uint32_t received = 0;
+    uint32_t errors = 0;
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < count; ++i) {
+            while (!ring.push({i, i * 2654435761u})) {
+                fullCount.fetch_add(1, std::memory_order_relaxed);
+                std::this_thread::yield();
+            }
+        }
+    });
+    std::thread consumer([&]() {
+        Item item;
+        while (received < count) {
+            if (!ring.pop(item)) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (item.mSequence != received || item.mCheck != received * 2654435761u) {
+                ++errors;
+            }
+            ++received;
+        }
+    });
+    producer.join();
+    consumer.join();
+
+    CHECK_EQ(received, count);
+    CHECK_EQ(errors, 0);
+    CHECK(ring.empty());
+    printf("ring of %u from %08x: %u items, producer found it full %u times\n",
+        SIZE, start, count, fullCount.load());
+}
+
+static std::atomic<bool> sAudioRunning{false};
+
+// the esp_timer task: ticks the audio timer, or wakes it when parked
+static void runAudioSide() {
+    esp_timer_handle_t audio = hostFindTimer("audioPlayer");
+    esp_timer_handle_t wake = hostFindTimer("audioWake");
+    while (sAudioRunning.load()) {
+        if (!hostFireTimer(audio) && !hostFireTimer(wake)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+static void countFinished(void* context) {
+    ++*(int*)context;
+}
+
+static bool waitUntilFinished(SoundManager& sound, const std::vector<SoundHandle>& handles) {
+    for (int tries = 0; tries < 2000; ++tries) {
+        sound.update();
+        bool finished = true;
+        for (SoundHandle handle : handles) {
+            finished &= sound.isFinished(handle);
+        }
+        if (finished && !sound.isPlaying()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+static void testLostEvents() {
+    hostUseRealClock(true);
+    Serial.mCapture = true;
+
+    static uint8_t samples[40];
+    memset(samples, 200, sizeof(samples));
+    const SoundFile blip = { sizeof(samples), samples };
+
+    SoundManager sound;
+    sound.setup(DAC1);
+    CHECK(!sound.isUsingDma());
+    sAudioRunning = true;
+    std::thread audio(runAudioSide);
+
+    // the game keeps up: every sound ends through its own event
+    std::vector<SoundHandle> handles;
+    int finished = 0;
+    for (int i = 0; i < 50; ++i) {
+        handles.push_back(sound.play(blip, false));
+        sound.onFinished(handles.back(), countFinished, &finished);
+        waitUntilFinished(sound, { handles.back() });
+    }
+    CHECK(waitUntilFinished(sound, handles));
+    CHECK_EQ(finished, 50);
+    CHECK(Serial.mCaptured.find("Sound events lost") == std::string::npos);
+
+    // the game doesn't look for a while and far more sounds end than the
+    // event ring holds, so it gives up on them all once it is quiet
+    handles.clear();
+    finished = 0;
+    for (int i = 0; i < 300; ++i) {
+        handles.push_back(sound.play(blip, false));
+        sound.onFinished(handles.back(), countFinished, &finished);
+    }
+    CHECK(waitUntilFinished(sound, handles));
+    CHECK_EQ(finished, 300);
+    CHECK(Serial.mCaptured.find("Sound events lost") != std::string::npos);
+
+    // and afterwards it goes back to telling them apart
+    Serial.mCaptured.clear();
+    const SoundHandle last = sound.play(blip, false);
+    CHECK(waitUntilFinished(sound, { last }));
+    CHECK(Serial.mCaptured.find("Sound events lost") == std::string::npos);
+
+    sAudioRunning = false;
+    audio.join();
+    Serial.mCapture = false;
+    hostUseRealClock(false);
+}
+
+int main() {
+    Serial.mEcho = false;
+    testFullAndEmpty(0);
+    testFullAndEmpty(0xFFFFFFFC);
+    testTwoThreads<8>(0, 2000000);
+    testTwoThreads<8>(0xFFFFFFFF - 1000000, 2000000);
+    testTwoThreads<32>(0xFFFFFFF0, 2000000);
+    testLostEvents();
+    return testResult("test_spsc_ring");
+}
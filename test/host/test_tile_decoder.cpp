@@ -0,0 +1,57 @@
+// Decoding compressed tiles: each op of tools/tile_codec.py's stream, and
+// a stream cut off partway through an op ending in black instead of being
+// read past its end.
+
+#include <vector>
+#include "host_stubs.h"
+#include "test_check.h"
+#include "tile_bitmap.h"
+
+static const uint16_t RED = 0xF800;
+
+// decodes the whole tile, with only the stream's own bytes readable
+static std::vector<uint16_t> decode(const std::vector<uint8_t>& stream, uint16_t width, uint16_t height) {
+    uint8_t* data = new uint8_t[stream.size()];
+    std::copy(stream.begin(), stream.end(), data);
+    const TileBitmap tile = {width, height, (uint32_t)stream.size(), data, TileCodec::Qoi};
+
+    std::vector<uint16_t> pixels(width * height);
+    TileDecoder decoder(tile);
+    for (uint16_t row = 0; row < height; ++row) {
+        decoder.decodeRow(pixels.data() + row * width);
+    }
+    delete[] data;
+    return pixels;
+}
+
+int main() {
+    // RAW red, RUN of 2, LUMA one step greener, DIFF back, INDEX of red
+    const uint8_t redHash = (31 * 3) & 63;
+    std::vector<uint16_t> pixels = decode({0xFE, 0xF8, 0x00, 0xC1, 0xA1, 0x88, 0x66, redHash}, 3, 2);
+    CHECK_EQ(pixels[0], RED);
+    CHECK_EQ(pixels[1], RED);
+    CHECK_EQ(pixels[2], RED);
+    CHECK_EQ(pixels[3], RED | (1 << 5));
+    CHECK_EQ(pixels[4], RED);
+    CHECK_EQ(pixels[5], RED);
+
+    // a RAW op missing its low byte ends the tile
+    pixels = decode({0xFE, 0xF8, 0x00, 0xFE, 0x07}, 3, 1);
+    CHECK_EQ(pixels[0], RED);
+    CHECK_EQ(pixels[1], 0);
+    CHECK_EQ(pixels[2], 0);
+
+    // as does a LUMA op missing its second byte
+    pixels = decode({0xFE, 0xF8, 0x00, 0xA1}, 3, 1);
+    CHECK_EQ(pixels[0], RED);
+    CHECK_EQ(pixels[1], 0);
+    CHECK_EQ(pixels[2], 0);
+
+    // and running out of ops, whatever came last
+    pixels = decode({0xFE, 0xF8, 0x00}, 2, 2);
+    CHECK_EQ(pixels[0], RED);
+    CHECK_EQ(pixels[1], 0);
+    CHECK_EQ(pixels[3], 0);
+
+    return testResult("test_tile_decoder");
+}
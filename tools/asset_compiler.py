@@ -0,0 +1,372 @@
+#!/usr/bin/env python3
+"""
+Asset compiler for Darkish Tower.
+
+Builds every generated asset from its source in one go, as listed in a
+manifest (assets.json at the top of the repo):
+
+    python3 tools/asset_compiler.py
+    python3 tools/asset_compiler.py --manifest assets.json --skip-pack --report sizes.txt
+
+Tiles come from PNG files (or any image Pillow reads), sounds from 8 bit
+mono WAV files, and either can also come from a header of raw arrays, as
+tile_codec.py and sound_codec.py read them. Fonts come from TTF files
+through Adafruit_GFX's fontconvert, which has to be on the PATH or named
+by "fontconvert" in the manifest. A font marked "optional" whose source
+isn't there is skipped and its header kept, as the game's font is
+licensed and isn't in the repo.
+
+The output is sounds.h and images.h, as the codecs write them, the font
+headers, and the asset pack and asset_names.h, as asset_pack.py writes
+them. Each part is only written if the manifest names it, and a file is
+only rewritten if its contents changed, so the sketch only rebuilds what
+it has to.
+
+Every asset picks its own codec, with the manifest's default for its
+kind otherwise:
+
+    tiles   qoi    compressed, see tile_codec.py
+            raw    big-endian RGB565, twice the size, drawn with a copy
+    sounds  auto   adpcm unless it comes out below min_snr
+            adpcm  4 bit IMA-ADPCM, see sound_codec.py
+            pcm    8 bit samples, mixed straight from flash
+    fonts   gfx    Adafruit_GFX's 1 bit glyph bitmaps, the only choice
+
+Assets whose coded data comes out identical are stored once, in the
+headers and in the pack.
+
+Coded assets are cached by a hash of their source, codec and settings,
+and of the codec's own source, or for fonts of the fontconvert program,
+so a rebuild only codes what changed.
+"""
+
+import argparse
+import glob
+import hashlib
+import json
+import os
+import re
+import shutil
+import struct
+import subprocess
+import sys
+import zlib
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import asset_pack  # noqa: E402
+import sound_codec  # noqa: E402
+import tile_codec  # noqa: E402
+
+TILE_CODECS = ["qoi", "raw"]
+SOUND_CODECS = ["auto", "adpcm", "pcm"]
+
+
+def read_png(path):
+    """Reads an 8 bit, non-interlaced PNG as RGB565 without Pillow."""
+    data = open(path, "rb").read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        sys.exit("%s: not a PNG file" % path)
+    pos = 8
+    idat = b""
+    palette = None
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b"IHDR":
+            width, height, depth, color, _, _, interlace = struct.unpack(">IIBBBBB", body)
+        elif kind == b"PLTE":
+            palette = [tuple(body[k:k + 3]) for k in range(0, len(body), 3)]
+        elif kind == b"IDAT":
+            idat += body
+        elif kind == b"IEND":
+            break
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(color)
+    if depth != 8 or interlace or channels is None:
+        sys.exit("%s: only 8 bit non-interlaced PNG files are supported" % path)
+
+    raw = zlib.decompress(idat)
+    stride = width * channels
+    previous = bytearray(stride)
+    pixels = []
+    pos = 0
+    for _ in range(height):
+        kind = raw[pos]
+        row = bytearray(raw[pos + 1:pos + 1 + stride])
+        pos += 1 + stride
+        for k in range(stride):
+            a = row[k - channels] if k >= channels else 0
+            b = previous[k]
+            c = previous[k - channels] if k >= channels else 0
+            if kind == 1:
+                row[k] = (row[k] + a) & 0xFF
+            elif kind == 2:
+                row[k] = (row[k] + b) & 0xFF
+            elif kind == 3:
+                row[k] = (row[k] + ((a + b) >> 1)) & 0xFF
+            elif kind == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                row[k] = (row[k] + (a if pa <= pb and pa <= pc else b if pb <= pc else c)) & 0xFF
+        previous = row
+        for x in range(width):
+            px = row[x * channels:(x + 1) * channels]
+            if color == 3:
+                r, g, b = palette[px[0]]
+            elif color in (0, 4):
+                r = g = b = px[0]
+            else:
+                r, g, b = px[0], px[1], px[2]
+            pixels.append(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3))
+
+    name = os.path.splitext(os.path.basename(path))[0]
+    return name, width, height, pixels
+
+
+def file_hash(path):
+    return hashlib.sha256(open(path, "rb").read()).hexdigest()
+
+
+class Cache:
+    """Coded assets on disk, keyed by everything that goes into them."""
+
+    def __init__(self, path, force):
+        self.path = path
+        self.force = force
+        self.hits = 0
+        self.misses = 0
+        os.makedirs(path, exist_ok=True)
+
+    def key(self, *parts):
+        return hashlib.sha256(json.dumps(parts, sort_keys=True).encode()).hexdigest()
+
+    def get(self, key, build):
+        path = os.path.join(self.path, key + ".json")
+        if not self.force and os.path.exists(path):
+            self.hits += 1
+            with open(path) as f:
+                return json.load(f)
+        self.misses += 1
+        value = build()
+        with open(path + ".tmp", "w") as f:
+            json.dump(value, f)
+        os.replace(path + ".tmp", path)
+        return value
+
+
+def expand(base, patterns):
+    paths = []
+    for pattern in patterns:
+        paths += sorted(glob.glob(os.path.join(base, pattern)))
+    return paths
+
+
+def compile_tiles(base, config, cache):
+    codec_hash = file_hash(tile_codec.__file__)
+    default = config.get("codec", "qoi")
+    tiles = []
+    for path in expand(base, config.get("sources", [])):
+        source = file_hash(path)
+        if path.endswith(".h"):
+            names = [name for name, _, _, _ in tile_codec.read_header(path)]
+        else:
+            names = [os.path.splitext(os.path.basename(path))[0]]
+
+        for name in names:
+            codec = config.get("codecs", {}).get(name, default)
+            if codec not in TILE_CODECS:
+                sys.exit("tile '%s': unknown codec '%s'" % (name, codec))
+
+            def build():
+                if path.endswith(".h"):
+                    tile = [t for t in tile_codec.read_header(path) if t[0] == name][0]
+                elif path.lower().endswith(".png"):
+                    tile = read_png(path)
+                else:
+                    tile = tile_codec.read_image(path)
+                _, width, height, pixels = tile
+                data = tile_codec.compress(name, pixels, codec)
+                return {"width": width, "height": height, "data": data.hex()}
+
+            value = cache.get(cache.key("tile", name, codec, source, codec_hash), build)
+            tiles.append((name, value["width"], value["height"], codec, bytes.fromhex(value["data"])))
+    return tiles
+
+
+def compile_sounds(base, config, cache):
+    codec_hash = file_hash(sound_codec.__file__)
+    default = config.get("codec", "auto")
+    settings = (config.get("lookahead", 2), config.get("min_snr", 8.0), config.get("min_silence", 64))
+    sounds = []
+    for path in expand(base, config.get("sources", [])):
+        source = file_hash(path)
+        if path.endswith(".h"):
+            names = [name for name, _, _ in sound_codec.read_header(path)]
+        else:
+            names = [os.path.splitext(os.path.basename(path))[0]]
+
+        for name in names:
+            codec = config.get("codecs", {}).get(name, default)
+            if codec not in SOUND_CODECS:
+                sys.exit("sound '%s': unknown codec '%s'" % (name, codec))
+
+            def build():
+                if path.endswith(".h"):
+                    sound = [s for s in sound_codec.read_header(path) if s[0] == name][0]
+                else:
+                    sound = sound_codec.read_wav(path)
+                _, samples, rate = sound
+                chosen, data, runs, description = sound_codec.compress(samples, *settings, codec=codec)
+                return {"samples": len(samples), "rate": rate, "codec": chosen, "data": data.hex(),
+                        "runs": runs, "description": description}
+
+            value = cache.get(cache.key("sound", name, codec, settings, source, codec_hash), build)
+            sounds.append((name, value["samples"], value["rate"], value["codec"], bytes.fromhex(value["data"]),
+                           [tuple(run) for run in value["runs"]], value["description"]))
+    return sounds
+
+
+def tool_version(tool):
+    """What the cache knows fontconvert by: its path, what it says it is,
+    and a hash of the program, as it has no version of its own to ask."""
+    path = shutil.which(tool)
+    if path is None:
+        sys.exit("fontconvert not found as '%s', put it on the PATH or name it in the manifest" % tool)
+    try:
+        banner = subprocess.run([path], stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                universal_newlines=True).stdout.strip()
+    except OSError as e:
+        sys.exit("%s: can't run fontconvert (%s)" % (path, e))
+    return [os.path.realpath(path), banner, file_hash(path)]
+
+
+def compile_font(base, config, tool, cache):
+    """Returns the header text and its size, or None for an optional font
+    whose source isn't there, leaving its header as it is."""
+    path = os.path.join(base, config["source"])
+    size = config["size"]
+    first = config.get("first", 0x20)
+    last = config.get("last", 0x7E)
+    if not os.path.exists(path):
+        if config.get("optional"):
+            print("%s: not found, keeping %s" % (config["source"], config["header"]))
+            return None
+        sys.exit("%s: not found" % path)
+
+    def build():
+        try:
+            text = subprocess.run([tool, path, str(size), str(first), str(last)], check=True,
+                                  stdout=subprocess.PIPE, universal_newlines=True).stdout
+        except (OSError, subprocess.CalledProcessError) as e:
+            sys.exit("%s: fontconvert failed (%s)" % (path, e))
+        return {"text": text}
+
+    key = cache.key("font", size, first, last, file_hash(path), tool_version(tool))
+    text = cache.get(key, build)["text"]
+    # fontconvert ends the header with its size
+    stored = re.search(r"Approx\. (\d+) bytes", text)
+    return text, int(stored.group(1)) if stored else len(text)
+
+
+def share(assets, key):
+    """Pairs each asset with the name of the first earlier one whose data
+    key matches, or None."""
+    first = {}
+    shared = []
+    for asset in assets:
+        k = key(asset)
+        shared.append(first.get(k))
+        first.setdefault(k, asset[0])
+    return shared
+
+
+def write_if_changed(path, text, written):
+    if os.path.exists(path) and open(path, "rb").read() == text:
+        return
+    with open(path, "wb") as f:
+        f.write(text)
+    written.append(path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile Darkish Tower assets from their sources")
+    parser.add_argument("--manifest", default="assets.json", help="the asset manifest")
+    parser.add_argument("--skip-headers", action="store_true", help="don't write the headers")
+    parser.add_argument("--skip-pack", action="store_true", help="don't write the asset pack")
+    parser.add_argument("--force", action="store_true", help="code every asset again, ignoring the cache")
+    parser.add_argument("--report", help="also write the size report to this file")
+    args = parser.parse_args()
+
+    with open(args.manifest) as f:
+        manifest = json.load(f)
+    base = os.path.dirname(os.path.abspath(args.manifest))
+    cache = Cache(os.path.join(base, manifest.get("cache", ".asset_cache")), args.force)
+
+    tiles = compile_tiles(base, manifest.get("tiles", {}), cache)
+    sounds = compile_sounds(base, manifest.get("sounds", {}), cache)
+    tool = manifest.get("fontconvert", "fontconvert")
+    fonts = [(config, compile_font(base, config, tool, cache)) for config in manifest.get("fonts", [])]
+    fonts = [(config, font) for config, font in fonts if font]
+
+    tile_shared = share(tiles, lambda t: (t[3], t[4]))
+    sound_shared = share(sounds, lambda s: (s[1], s[3], s[4], tuple(s[5])))
+
+    report = ["%-16s %-6s %-8s %8s %8s %6s  %s" % ("asset", "kind", "codec", "raw", "stored", "ratio", "")]
+    totals = {}
+
+    def add(name, kind, codec, raw, stored, note):
+        report.append("%-16s %-6s %-8s %8d %8d %5.0f%%  %s" % (name, kind, codec, raw, stored, 100.0 * stored / raw, note))
+        total = totals.setdefault(kind, [0, 0])
+        total[0] += raw
+        total[1] += stored
+
+    for (name, width, height, codec, data), shared in zip(tiles, tile_shared):
+        add(name, "tile", codec, width * height * 2, 0 if shared else len(data), "same as " + shared if shared else "")
+    for (name, count, rate, codec, data, runs, description), shared in zip(sounds, sound_shared):
+        note = "same as " + shared if shared else "%s, %d silence runs" % (description, len(runs))
+        add(name, "sound", codec, count, 0 if shared else len(data) + 8 * len(runs), note)
+    for config, (text, stored) in fonts:
+        name = os.path.splitext(os.path.basename(config["header"]))[0]
+        add(name, "font", "gfx", stored, stored, "")
+    for kind, (raw, stored) in sorted(totals.items()):
+        report.append("%-16s %-6s %-8s %8d %8d %5.0f%%" % ("total", kind, "", raw, stored, 100.0 * stored / raw))
+    report.append("%d coded, %d from the cache" % (cache.misses, cache.hits))
+
+    written = []
+    if not args.skip_headers:
+        if tiles and "header" in manifest.get("tiles", {}):
+            text, _ = tile_codec.header_text([t + (s,) for t, s in zip(tiles, tile_shared)])
+            write_if_changed(os.path.join(base, manifest["tiles"]["header"]), text.encode(), written)
+        if sounds and "header" in manifest.get("sounds", {}):
+            text, _ = sound_codec.header_text([s + (shared,) for s, shared in zip(sounds, sound_shared)])
+            write_if_changed(os.path.join(base, manifest["sounds"]["header"]), text.encode(), written)
+        for config, (text, _) in fonts:
+            write_if_changed(os.path.join(base, config["header"]), text.encode(), written)
+
+    if not args.skip_pack and "pack" in manifest and (tiles or sounds):
+        pack = manifest["pack"]
+        pack_sounds = [(name, asset_pack.CODECS[sound_codec.CODECS[codec].split("::")[1]], count, rate or 0, data, runs)
+                       for name, count, rate, codec, data, runs, _ in sounds]
+        pack_tiles = [(name, width, height, asset_pack.TILE_CODECS[tile_codec.CODECS[codec].split("::")[1]], data)
+                      for name, width, height, codec, data in tiles]
+        temp = os.path.join(cache.path, "pack.tmp")
+        size = asset_pack.write_pack(temp, pack_sounds, pack_tiles)
+        write_if_changed(os.path.join(base, pack["output"]), open(temp, "rb").read(), written)
+        if "names" in pack:
+            asset_pack.write_names(temp, pack_sounds, pack_tiles)
+            write_if_changed(os.path.join(base, pack["names"]), open(temp, "rb").read(), written)
+        os.remove(temp)
+        partition = int(str(pack.get("partition_size", 0x100000)), 0)
+        report.append("pack %d bytes, %.0f%% of the partition" % (size, 100.0 * size / partition))
+        if size > partition:
+            sys.exit("the pack does not fit the partition")
+
+    report.append("wrote " + (", ".join(os.path.relpath(p, base) for p in written) if written else "nothing, all up to date"))
+    print("\n".join(report))
+    if args.report:
+        with open(args.report, "w") as f:
+            f.write("\n".join(report) + "\n")
+
+
+if __name__ == "__main__":
+    main()
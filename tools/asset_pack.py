@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""
+Asset pack builder for Darkish Tower.
+
+Packs the sounds and tiles made by tools/sound_codec.py and
+tools/tile_codec.py into one bundle for the "assets" flash partition,
+read by AssetPack (main/src/asset_pack.cpp), and writes asset_names.h,
+the header the game builds against when ASSETS_IN_PARTITION is set:
+
+    python3 tools/asset_pack.py --sounds main/src/assets/sounds.h \\
+        --images main/src/assets/images.h -o assets.bin \\
+        --names main/src/assets/asset_names.h
+
+The header names every asset but holds no data, the game fills them in
+from the pack at boot, so the pack can be rebuilt and flashed on its own
+as long as no asset is added or renamed:
+
+    esptool.py --chip esp32s2 write_flash 0x210000 assets.bin
+
+The host build maps the same file, from $ASSET_PACK or ./assets.bin.
+
+The layout, all little endian, offsets from the start of the pack:
+
+    header  magic "DTAP", u16 version, u16 count, u32 size, u32 reserved
+    index   count entries of 48 bytes:
+              char name[20], u8 kind, u8 format, u16 reserved,
+              u32 offset, u32 size, u32 param0, u32 param1,
+              u32 silence_offset, u32 silence_count
+    data    every asset's data, then a sound's SoundRun table, each on a
+            4 byte boundary
+
+A sound is kind 0, its format a SoundCodec, param0 its samples and
+param1 its rate. A tile is kind 1, its format a TileCodec, param0 and
+param1 its width and height. Data shared by several assets is stored
+once.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+MAGIC = b"DTAP"
+VERSION = 1
+NAME_LENGTH = 20
+HEADER = struct.Struct("<4sHHII")
+ENTRY = struct.Struct("<%dsBBHIIIIII" % NAME_LENGTH)
+KIND_SOUND = 0
+KIND_TILE = 1
+CODECS = {"Pcm8": 0, "ImaAdpcm": 1}
+TILE_CODECS = {"Qoi": 0, "Raw": 1}
+
+
+def parse_bytes(body):
+    return bytes(int(v, 0) for v in re.findall(r"0x[0-9a-fA-F]+|\d+", body))
+
+
+def read_sounds(path):
+    """Reads the sounds back out of a header written by sound_codec.py."""
+    text = open(path).read()
+    counts = dict((n, int(c)) for n, c in re.findall(r"const uint32_t (\w+)_sample_count = (\d+);", text))
+    data = dict((n, parse_bytes(b)) for n, b in
+                re.findall(r"const uint8_t (\w+)_sample_data\[\w+\]\s*PROGMEM\s*=\s*\{(.*?)\};", text, re.S))
+    silence = {}
+    for name, body in re.findall(r"const SoundRun (\w+)_silence\[\d+\]\s*PROGMEM\s*=\s*\{(.*?)\};", text, re.S):
+        silence[name] = [(int(a), int(b)) for a, b in re.findall(r"\{\s*(\d+),\s*(\d+)\s*\}", body)]
+
+    sounds = []
+    pattern = r"SoundFile (\w+)_snd = \{ (\w+)_sample_count, \w+, SoundCodec::(\w+), (\w+)"
+    for name, source, codec, rate in re.findall(pattern, text):
+        rate = 0 if rate == "SOUND_DEFAULT_RATE" else int(rate)
+        sounds.append((name, CODECS[codec], counts[source], rate, data[source], silence.get(source, [])))
+    return sounds
+
+
+def read_tiles(path):
+    """Reads the tiles back out of a header written by tile_codec.py."""
+    text = open(path).read()
+    data = dict((n, parse_bytes(b)) for n, b in
+                re.findall(r"const uint8_t (\w+)_tile_data\[\w+\]\s*PROGMEM\s*=\s*\{(.*?)\};", text, re.S))
+    tiles = []
+    pattern = r"const TileBitmap tile_bitmap_(\w+) = \{ (\d+), (\d+), (\w+)_tile_size, \w+(?:, TileCodec::(\w+))? \};"
+    for name, width, height, source, codec in re.findall(pattern, text):
+        tiles.append((name, int(width), int(height), TILE_CODECS[codec or "Qoi"], data[source]))
+    return tiles
+
+
+def align(blob):
+    blob.extend(b"\0" * (-len(blob) % 4))
+
+
+def write_pack(path, sounds, tiles):
+    entries = []
+    blob = bytearray()
+    start = HEADER.size + ENTRY.size * (len(sounds) + len(tiles))
+
+    # identical data is stored once, whichever assets it belongs to
+    stored = {}
+
+    def add(data):
+        if data not in stored:
+            stored[data] = start + len(blob)
+            blob.extend(data)
+            align(blob)
+        return stored[data]
+
+    for name, codec, count, rate, data, runs in sounds:
+        offset = add(data)
+        silence_offset = add(b"".join(struct.pack("<II", *run) for run in runs)) if runs else 0
+        entries.append((name, KIND_SOUND, codec, offset, len(data), count, rate, silence_offset, len(runs)))
+
+    for name, width, height, codec, data in tiles:
+        entries.append((name, KIND_TILE, codec, add(data), len(data), width, height, 0, 0))
+
+    out = bytearray(HEADER.pack(MAGIC, VERSION, len(entries), start + len(blob), 0))
+    for name, kind, fmt, offset, size, param0, param1, silence_offset, silence_count in entries:
+        if len(name) > NAME_LENGTH:
+            sys.exit("asset name '%s' is longer than %d characters" % (name, NAME_LENGTH))
+        out += ENTRY.pack(name.encode(), kind, fmt, 0, offset, size, param0, param1, silence_offset, silence_count)
+    out += blob
+
+    with open(path, "wb") as f:
+        f.write(out)
+    return len(out)
+
+
+def write_names(path, sounds, tiles):
+    lines = []
+    lines.append('#include "../asset_pack.h"')
+    lines.append("")
+    lines.append("// generated by tools/asset_pack.py, do not edit")
+    lines.append("// Every asset in the pack, empty until loadAssets() points them at it.")
+    lines.append("")
+    for name, _, _, _, _, _ in sounds:
+        lines.append("SoundFile %s_snd = {};" % name)
+    lines.append("")
+    lines.append("const int sound_assets_LEN = %d;" % len(sounds))
+    lines.append("const SoundAsset sound_assets[%d] = {" % len(sounds))
+    lines.append(",\n".join('\t{ "%s", &%s_snd }' % (name, name) for name, _, _, _, _, _ in sounds))
+    lines.append("};")
+    lines.append("")
+    for name, _, _, _, _ in tiles:
+        lines.append("TileBitmap tile_bitmap_%s = {};" % name)
+    lines.append("")
+    lines.append("const int tile_bitmap_allArray_LEN = %d;" % len(tiles))
+    lines.append("const TileBitmap* tile_bitmap_allArray[%d] = {" % len(tiles))
+    lines.append(",\n".join("\t&tile_bitmap_%s" % name for name, _, _, _, _ in tiles))
+    lines.append("};")
+    lines.append("")
+    lines.append("const int tile_assets_LEN = %d;" % len(tiles))
+    lines.append("const TileAsset tile_assets[%d] = {" % len(tiles))
+    lines.append(",\n".join('\t{ "%s", &tile_bitmap_%s }' % (name, name) for name, _, _, _, _ in tiles))
+    lines.append("};")
+
+    with open(path, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pack Darkish Tower assets for the asset partition")
+    parser.add_argument("--sounds", required=True, help="sounds.h from sound_codec.py")
+    parser.add_argument("--images", required=True, help="images.h from tile_codec.py")
+    parser.add_argument("--names", help="asset_names.h to write for ASSETS_IN_PARTITION builds")
+    parser.add_argument("--partition-size", type=lambda v: int(v, 0), default=0x100000,
+                        help="size of the assets partition in partitions_assets.csv")
+    parser.add_argument("-o", "--output", required=True, help="pack to write")
+    args = parser.parse_args()
+
+    sounds = read_sounds(args.sounds)
+    tiles = read_tiles(args.images)
+    if not sounds and not tiles:
+        sys.exit("no assets found")
+
+    size = write_pack(args.output, sounds, tiles)
+    if args.names:
+        write_names(args.names, sounds, tiles)
+    print("%d sounds, %d tiles, %d bytes (%.0f%% of the partition)"
+          % (len(sounds), len(tiles), size, 100.0 * size / args.partition_size))
+    if size > args.partition_size:
+        sys.exit("the pack does not fit the partition")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,293 @@
+#!/usr/bin/env python3
+"""
+Sound codec for Darkish Tower.
+
+Encodes 8 bit unsigned PCM sounds into 4 bit IMA-ADPCM, as read by
+SoundDecoder (main/src/sound_file.cpp), and writes them out as a
+sounds.h header. Sounds can come from 8 bit mono WAV files or from an
+existing header of raw sample arrays, which is how the sounds were
+originally stored:
+
+    python3 tools/sound_codec.py --header old_sounds.h -o main/src/assets/sounds.h
+    python3 tools/sound_codec.py --wavs audio/*.wav -o main/src/assets/sounds.h
+
+The stream is standard IMA-ADPCM on 16 bit samples, two samples a byte,
+low nibble first. An 8 bit sample s is coded as (s << 8) - 32768 and
+decoded back with (predictor + 32768) >> 8. The decoder starts with the
+predictor at -32768 (silence) and a step index of 0.
+
+The encoder tries every code for each sample and keeps the one that
+tracks the next --lookahead samples best, which copes much better with
+the sharp edges in these sounds than the usual greedy quantizer. Any
+sound that comes out below --min-snr dB is kept as PCM.
+
+Sounds from WAV files keep their sample rate, and are resampled to the
+output rate as they play.
+
+Runs of at least --min-silence zero samples are left out of the data
+and listed in a SoundRun table instead, so they cost 8 bytes each
+whatever their length, and the player can sleep through them. The
+samples either side of a run are coded as if they were adjacent.
+"""
+
+import argparse
+import math
+import os
+import re
+import sys
+import wave
+
+STEPS = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767,
+]
+INDEX_STEP = [-1, -1, -1, -1, 2, 4, 6, 8]
+
+
+def step(code, pred, index):
+    """Applies one code to the decoder state, exactly as the decoder does."""
+    s = STEPS[index]
+    diff = s >> 3
+    if code & 4:
+        diff += s
+    if code & 2:
+        diff += s >> 1
+    if code & 1:
+        diff += s >> 2
+    pred = pred - diff if code & 8 else pred + diff
+    pred = max(-32768, min(32767, pred))
+    index = max(0, min(88, index + INDEX_STEP[code & 7]))
+    return pred, index
+
+
+def quantize(x, pred, index):
+    """The usual greedy IMA quantizer."""
+    s = STEPS[index]
+    diff = x - pred
+    code = 0
+    if diff < 0:
+        code = 8
+        diff = -diff
+    if diff >= s:
+        code |= 4
+        diff -= s
+    s >>= 1
+    if diff >= s:
+        code |= 2
+        diff -= s
+    s >>= 1
+    if diff >= s:
+        code |= 1
+    return code
+
+
+def encode(samples, lookahead):
+    targets = [(s << 8) - 32768 for s in samples]
+    codes = []
+    pred, index = -32768, 0
+    for k, x in enumerate(targets):
+        best_code = quantize(x, pred, index)
+        if lookahead > 0:
+            ahead = targets[k + 1:k + 1 + lookahead]
+            best_error = None
+            for code in range(16):
+                p, i = step(code, pred, index)
+                error = (p - x) ** 2
+                for y in ahead:
+                    p, i = step(quantize(y, p, i), p, i)
+                    error += (p - y) ** 2
+                if best_error is None or error < best_error:
+                    best_error = error
+                    best_code = code
+        pred, index = step(best_code, pred, index)
+        codes.append(best_code)
+
+    out = bytearray()
+    for k in range(0, len(codes), 2):
+        high = codes[k + 1] if k + 1 < len(codes) else 0
+        out.append(codes[k] | (high << 4))
+    return bytes(out)
+
+
+def decode(data, count):
+    """Reference decoder, gives back the 8 bit samples the device will play."""
+    samples = []
+    pred, index = -32768, 0
+    for k in range(count):
+        code = (data[k >> 1] >> (4 * (k & 1))) & 0x0F
+        pred, index = step(code, pred, index)
+        samples.append((pred + 32768) >> 8)
+    return samples
+
+
+def snr(original, decoded):
+    mean = sum(original) / len(original)
+    signal = sum((s - mean) ** 2 for s in original)
+    noise = sum((a - b) ** 2 for a, b in zip(original, decoded))
+    if noise == 0:
+        return float("inf")
+    return 10 * math.log10(max(signal, 1e-9) / noise)
+
+
+def find_silence(samples, min_length):
+    """Runs of zero samples at least min_length long, as (start, length)."""
+    runs = []
+    k = 0
+    while k < len(samples):
+        if samples[k] != 0:
+            k += 1
+            continue
+        start = k
+        while k < len(samples) and samples[k] == 0:
+            k += 1
+        if k - start >= min_length:
+            runs.append((start, k - start))
+    return runs
+
+
+def strip_silence(samples, runs):
+    audible = []
+    k = 0
+    for start, length in runs:
+        audible += samples[k:start]
+        k = start + length
+    return audible + samples[k:]
+
+
+def restore_silence(audible, runs, count):
+    samples = []
+    k = 0
+    for start, length in runs:
+        take = start - len(samples)
+        samples += audible[k:k + take] + [0] * length
+        k += take
+    return samples + audible[k:k + count - len(samples)]
+
+
+def read_header(path):
+    """Reads sounds from a header of raw uint8_t sample arrays, made for
+    the default rate."""
+    text = open(path).read()
+    sounds = []
+    pattern = r"const uint8_t (\w+)_sample_data\[\w+\]\s*PROGMEM\s*=\s*\{(.*?)\};"
+    for name, body in re.findall(pattern, text, re.S):
+        sounds.append((name, [int(v) for v in re.findall(r"\d+", body)], None))
+    return sounds
+
+
+def read_wav(path):
+    with wave.open(path) as w:
+        if w.getsampwidth() != 1 or w.getnchannels() != 1:
+            sys.exit("%s: only 8 bit mono wav files are supported" % path)
+        samples = list(w.readframes(w.getnframes()))
+        rate = w.getframerate()
+    return os.path.splitext(os.path.basename(path))[0], samples, rate
+
+
+CODECS = {"pcm": "SoundCodec::Pcm8", "adpcm": "SoundCodec::ImaAdpcm"}
+
+# SOUND_DEFAULT_RATE in sound_file.h
+DEFAULT_RATE = 7936
+
+
+def compress(samples, lookahead, min_snr, min_silence, codec="auto"):
+    """Codes a sound with codec, or with auto as ADPCM unless that comes
+    out below min_snr. Returns (codec, data, silence runs, description)."""
+    runs = find_silence(samples, min_silence)
+    audible = strip_silence(samples, runs)
+    if codec == "pcm":
+        return "pcm", bytes(audible), runs, "PCM"
+
+    data = encode(audible, lookahead)
+    decoded = restore_silence(decode(data, len(audible)), runs, len(samples))
+    quality = snr(samples, decoded)
+    if codec == "auto" and quality < min_snr:
+        return "pcm", bytes(audible), runs, "PCM"
+    return "adpcm", data, runs, "%.1f dB" % quality
+
+
+def header_text(sounds):
+    """The sounds.h text for sounds of (name, samples, rate, codec, data,
+    runs, description, shared), where shared names an earlier sound with
+    the same data and runs to point at instead of storing them again.
+    Returns the text and the bytes stored."""
+    lines = []
+    files = []
+    total = 0
+    for name, count, rate, codec, data, runs, description, shared in sounds:
+        source = shared or name
+        silence = ", %s_silence, %d" % (source, len(runs)) if runs else ""
+        files.append("SoundFile %s_snd = { %s_sample_count, %s_sample_data, %s, %s%s };"
+                     % (name, source, source, CODECS[codec], rate if rate and rate != DEFAULT_RATE else "SOUND_DEFAULT_RATE", silence))
+        if shared:
+            continue
+
+        stored = len(data) + 8 * len(runs)
+        total += stored
+        lines.append("// %s, %d bytes (raw %d), %s" % (name, stored, count, description))
+        lines.append("const uint32_t %s_sample_count = %d;" % (name, count))
+        lines.append("const uint8_t %s_sample_data[%d] PROGMEM = {" % (name, len(data)))
+        for row in range(0, len(data), 32):
+            lines.append("\t" + ", ".join("0x%02x" % v for v in data[row:row + 32]) + ",")
+        lines.append("};")
+        if runs:
+            lines.append("const SoundRun %s_silence[%d] PROGMEM = {" % (name, len(runs)))
+            for row in range(0, len(runs), 6):
+                lines.append("\t" + " ".join("{ %d, %d }," % run for run in runs[row:row + 6]))
+            lines.append("};")
+        lines.append("")
+
+    text = '#include "../sound_manager.h"\n\n'
+    text += "//*************\n// AUDIO FILES\n//*************\n\n"
+    text += "// generated by tools/sound_codec.py, do not edit\n"
+    text += "// (Total bytes used to store sounds in PROGMEM = %d)\n\n" % total
+    text += "\n".join(lines) + "\n"
+    text += "//*************\n// SOUNDS\n//*************\n\n"
+    text += "\n".join(files) + "\n"
+    return text, total
+
+
+def write_header(path, sounds, lookahead, min_snr, min_silence):
+    encoded = []
+    raw = 0
+    for name, samples, rate in sounds:
+        codec, data, runs, description = compress(samples, lookahead, min_snr, min_silence)
+        full = len(samples) if codec == "pcm" else (len(samples) + 1) // 2
+        stored = len(data) + 8 * len(runs)
+        print("%-16s %6d samples, %6d bytes, %s, %d silence runs saved %d bytes"
+              % (name, len(samples), stored, description, len(runs), full - stored))
+        encoded.append((name, len(samples), rate, codec, data, runs, description, None))
+        raw += len(samples)
+
+    text, total = header_text(encoded)
+    with open(path, "w") as f:
+        f.write(text)
+    return total, raw
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Encode Darkish Tower sounds")
+    parser.add_argument("--header", help="header of raw 8 bit sample arrays")
+    parser.add_argument("--wavs", nargs="*", default=[], help="8 bit mono wav files, one sound each")
+    parser.add_argument("--lookahead", type=int, default=2, help="samples the encoder looks ahead")
+    parser.add_argument("--min-snr", type=float, default=8.0, help="keep sounds below this SNR (dB) as PCM")
+    parser.add_argument("--min-silence", type=int, default=64, help="shortest run of zeros left out of the data")
+    parser.add_argument("-o", "--output", required=True, help="header to write")
+    args = parser.parse_args()
+
+    sounds = read_header(args.header) if args.header else []
+    sounds += [read_wav(path) for path in args.wavs]
+    if not sounds:
+        sys.exit("no sounds found")
+
+    total, raw = write_header(args.output, sounds, args.lookahead, args.min_snr, args.min_silence)
+    print("%d sounds, %d bytes (raw %d, %.0f%%)" % (len(sounds), total, raw, 100.0 * total / raw))
+
+
+if __name__ == "__main__":
+    main()
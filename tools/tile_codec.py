@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+"""
+Tile codec for Darkish Tower.
+
+Encodes RGB565 tile bitmaps into the compact format read by TileDecoder
+(main/src/tile_bitmap.cpp) and writes them out as an images.h header.
+
+Tiles can come from image files (needs Pillow) or from an existing header
+made by image2cpp, which is how the raw tiles were originally generated:
+
+    python3 tools/tile_codec.py --header old_images.h -o main/src/assets/images.h
+    python3 tools/tile_codec.py --images art/*.png -o main/src/assets/images.h
+
+Tiles can also be stored raw with --codec raw, as big-endian RGB565,
+which takes twice the flash but draws with a plain copy.
+
+The format is a byte stream in the spirit of QOI, working on RGB565 and
+predicting from the previous pixel. Decoder state carries over between
+rows, so the decoder can emit one scanline at a time.
+
+    00iiiiii              INDEX  pixel = index[i]
+    01rrggbb              DIFF   r,g,b each -2..1 from the previous pixel
+    10gggggg rrrrbbbb     LUMA   g -32..31, r and b -8..7 relative to g/2
+    11nnnnnn (n < 62)     RUN    repeat the previous pixel n+1 times
+    11111110 hhhhhhhh llllllll  RAW  a literal RGB565 pixel
+
+Every pixel produced by DIFF, LUMA or RAW is stored in index[hash(pixel)].
+The decoder starts with a black previous pixel and a zeroed index.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+OP_INDEX = 0x00
+OP_DIFF = 0x40
+OP_LUMA = 0x80
+OP_RUN = 0xC0
+OP_RAW = 0xFE
+MAX_RUN = 62
+
+
+def split565(p):
+    return (p >> 11) & 0x1F, (p >> 5) & 0x3F, p & 0x1F
+
+
+def color_hash(p):
+    r, g, b = split565(p)
+    return (r * 3 + g * 5 + b * 7) & 63
+
+
+def encode(pixels):
+    out = bytearray()
+    index = [0] * 64
+    prev = 0
+    run = 0
+    for p in pixels:
+        if p == prev:
+            run += 1
+            if run == MAX_RUN:
+                out.append(OP_RUN | (run - 1))
+                run = 0
+            continue
+        if run:
+            out.append(OP_RUN | (run - 1))
+            run = 0
+
+        h = color_hash(p)
+        if index[h] == p:
+            out.append(OP_INDEX | h)
+            prev = p
+            continue
+        index[h] = p
+
+        r, g, b = split565(p)
+        pr, pg, pb = split565(prev)
+        dr, dg, db = r - pr, g - pg, b - pb
+        dr_dg = dr - (dg >> 1)
+        db_dg = db - (dg >> 1)
+        if -2 <= dr <= 1 and -2 <= dg <= 1 and -2 <= db <= 1:
+            out.append(OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2))
+        elif -32 <= dg <= 31 and -8 <= dr_dg <= 7 and -8 <= db_dg <= 7:
+            out.append(OP_LUMA | (dg + 32))
+            out.append(((dr_dg + 8) << 4) | (db_dg + 8))
+        else:
+            out.append(OP_RAW)
+            out.append(p >> 8)
+            out.append(p & 0xFF)
+        prev = p
+
+    if run:
+        out.append(OP_RUN | (run - 1))
+    return bytes(out)
+
+
+def decode(data, count):
+    """Reference decoder, used to check every tile round-trips."""
+    pixels = []
+    index = [0] * 64
+    prev = 0
+    pos = 0
+    while len(pixels) < count:
+        op = data[pos]
+        pos += 1
+        if op == OP_RAW:
+            prev = (data[pos] << 8) | data[pos + 1]
+            pos += 2
+            index[color_hash(prev)] = prev
+        elif op >= OP_RUN:
+            pixels.extend([prev] * ((op & 0x3F) + 1))
+            continue
+        elif op >= OP_LUMA:
+            dg = (op & 0x3F) - 32
+            second = data[pos]
+            pos += 1
+            dr = (second >> 4) - 8 + (dg >> 1)
+            db = (second & 0x0F) - 8 + (dg >> 1)
+            pr, pg, pb = split565(prev)
+            prev = (((pr + dr) & 0x1F) << 11) | (((pg + dg) & 0x3F) << 5) | ((pb + db) & 0x1F)
+            index[color_hash(prev)] = prev
+        elif op >= OP_DIFF:
+            pr, pg, pb = split565(prev)
+            r = (pr + ((op >> 4) & 3) - 2) & 0x1F
+            g = (pg + ((op >> 2) & 3) - 2) & 0x3F
+            b = (pb + (op & 3) - 2) & 0x1F
+            prev = (r << 11) | (g << 5) | b
+            index[color_hash(prev)] = prev
+        else:
+            prev = index[op]
+        pixels.append(prev)
+    return pixels
+
+
+def read_header(path):
+    """Reads tiles from an image2cpp style header of raw uint16_t arrays."""
+    text = open(path).read()
+    tiles = []
+    pattern = r"//\s*'(\w+)',\s*(\d+)x(\d+)px\s*const uint16_t \w+\s*\[\]\s*PROGMEM\s*=\s*\{(.*?)\};"
+    for name, width, height, body in re.findall(pattern, text, re.S):
+        pixels = [int(v, 16) for v in re.findall(r"0x[0-9a-fA-F]+", body)]
+        tiles.append((name, int(width), int(height), pixels))
+    return tiles
+
+
+def read_image(path):
+    from PIL import Image
+    image = Image.open(path).convert("RGB")
+    width, height = image.size
+    pixels = []
+    for r, g, b in image.getdata():
+        pixels.append(((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3))
+    name = os.path.splitext(os.path.basename(path))[0]
+    return name, width, height, pixels
+
+
+CODECS = {"qoi": "TileCodec::Qoi", "raw": "TileCodec::Raw"}
+
+
+def encode_raw(pixels):
+    """Big-endian RGB565, the panel's order, so rows copy straight out."""
+    out = bytearray()
+    for p in pixels:
+        out += bytes((p >> 8, p & 0xFF))
+    return bytes(out)
+
+
+def compress(name, pixels, codec):
+    if codec == "raw":
+        return encode_raw(pixels)
+    data = encode(pixels)
+    if decode(data, len(pixels)) != pixels:
+        sys.exit("tile '%s' did not round-trip" % name)
+    return data
+
+
+def header_text(tiles):
+    """The images.h text for tiles of (name, width, height, codec, data,
+    shared), where shared names an earlier tile with the same data to
+    point at instead of storing it again. Returns the text and the bytes
+    stored."""
+    lines = []
+    total = 0
+    for name, width, height, codec, data, shared in tiles:
+        if shared:
+            continue
+        total += len(data)
+        lines.append("// '%s', %dx%dpx, %d bytes (raw %d)" % (name, width, height, len(data), width * height * 2))
+        lines.append("const uint32_t %s_tile_size = %d;" % (name, len(data)))
+        lines.append("const uint8_t %s_tile_data[%s_tile_size] PROGMEM = {" % (name, name))
+        for row in range(0, len(data), 32):
+            lines.append("\t" + ", ".join("0x%02x" % v for v in data[row:row + 32]) + ",")
+        lines.append("};")
+        lines.append("")
+
+    for name, width, height, codec, data, shared in tiles:
+        source = shared or name
+        suffix = "" if codec == "qoi" else ", " + CODECS[codec]
+        lines.append("const TileBitmap tile_bitmap_%s = { %d, %d, %s_tile_size, %s_tile_data%s };"
+                     % (name, width, height, source, source, suffix))
+    lines.append("")
+    lines.append("// Array of all bitmaps for convenience. (Total bytes used to store images in PROGMEM = %d)" % total)
+    lines.append("const int tile_bitmap_allArray_LEN = %d;" % len(tiles))
+    lines.append("const TileBitmap* tile_bitmap_allArray[%d] = {" % len(tiles))
+    lines.append(",\n".join("\t&tile_bitmap_%s" % t[0] for t in tiles))
+    lines.append("};")
+
+    text = '#include "../tile_bitmap.h"\n\n'
+    text += "//*************\n// TILE IMAGES\n//*************\n\n"
+    text += "// generated by tools/tile_codec.py, do not edit\n\n"
+    text += "\n".join(lines) + "\n"
+    return text, total
+
+
+def write_header(path, tiles, codec):
+    encoded = [(name, width, height, codec, compress(name, pixels, codec), None)
+               for name, width, height, pixels in tiles]
+    text, total = header_text(encoded)
+    with open(path, "w") as f:
+        f.write(text)
+    return total
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Encode Darkish Tower tile bitmaps")
+    parser.add_argument("--header", help="image2cpp header of raw RGB565 tiles")
+    parser.add_argument("--images", nargs="*", default=[], help="image files, one tile each")
+    parser.add_argument("--codec", choices=sorted(CODECS), default="qoi",
+                        help="qoi to compress, raw for the fastest drawing")
+    parser.add_argument("-o", "--output", required=True, help="header to write")
+    args = parser.parse_args()
+
+    tiles = read_header(args.header) if args.header else []
+    tiles += [read_image(path) for path in args.images]
+    if not tiles:
+        sys.exit("no tiles found")
+
+    raw = sum(len(t[3]) * 2 for t in tiles)
+    total = write_header(args.output, tiles, args.codec)
+    print("%d tiles, %d bytes (raw %d, %.0f%%)" % (len(tiles), total, raw, 100.0 * total / raw))
+
+
+if __name__ == "__main__":
+    main()